@@ -22,6 +22,10 @@ DEFINES += QT_DEPRECATED_WARNINGS
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# Uncomment to compile in execution tracing of the Interpreter (see "tracer.h").
+# It still has to be switched on at runtime with "Tracer::setEnabled(true)".
+#DEFINES += ES_TRACE
+
 
 SOURCES += \
         main.cpp \
@@ -30,7 +34,25 @@ SOURCES += \
     newprojectdialog.cpp \
     interpreter.cpp \
     interpreterwindow.cpp \
-    resultwindow.cpp
+    resultwindow.cpp \
+    symboltable.cpp \
+    workstealingpool.cpp \
+    batchexecutor.cpp \
+    ruleprogram.cpp \
+    interpretersession.cpp \
+    rulegraph.cpp \
+    tracer.cpp \
+    bitsetinterpreter.cpp \
+    lookuptable.cpp \
+    resultcache.cpp \
+    specializationcache.cpp \
+    decisiondiagram.cpp \
+    ruleoptimizer.cpp \
+    ruleminimizer.cpp \
+    binaryprojectfile.cpp \
+    textprojectparser.cpp \
+    projectjournal.cpp \
+    projectsaver.cpp
 
 HEADERS += \
         mainwindow.h \
@@ -38,7 +60,25 @@ HEADERS += \
     newprojectdialog.h \
     interpreter.h \
     interpreterwindow.h \
-    resultwindow.h
+    resultwindow.h \
+    symboltable.h \
+    ruleprogram.h \
+    workstealingpool.h \
+    batchexecutor.h \
+    interpretersession.h \
+    rulegraph.h \
+    tracer.h \
+    bitsetinterpreter.h \
+    lookuptable.h \
+    resultcache.h \
+    specializationcache.h \
+    decisiondiagram.h \
+    ruleoptimizer.h \
+    ruleminimizer.h \
+    binaryprojectfile.h \
+    textprojectparser.h \
+    projectjournal.h \
+    projectsaver.h
 
 FORMS += \
         mainwindow.ui \
@@ -0,0 +1,40 @@
+#include "batchexecutor.h"
+
+
+BatchExecutor::BatchExecutor(const Interpreter &interp, int threadCount) :
+    interp(interp),
+    bitsetInterp(nullptr),
+    pool(threadCount)
+{
+    
+}
+
+BatchExecutor::BatchExecutor(const BitsetInterpreter &bitsetInterp, int threadCount) :
+    interp(bitsetInterp.getInterpreter()),
+    bitsetInterp(&bitsetInterp),
+    pool(threadCount)
+{
+    
+}
+
+int BatchExecutor::getThreadCount() const
+{
+    return pool.getThreadCount();
+}
+
+void BatchExecutor::interpretBatch(const Interpreter::BatchInput &input, Interpreter::BatchOutput &output, int chunkSize)
+{
+    if (chunkSize <= 0) chunkSize = 1;
+    
+    int rowCount = input.rowCount;
+    int chunkCount = static_cast<int>((static_cast<qint64>(rowCount) + chunkSize - 1) / chunkSize);
+    
+    // Both engines are immutable, so all threads share them
+    pool.run(chunkCount, [&](int chunk)
+    {
+        int firstRow = chunk * chunkSize;
+        int rows = qMin(chunkSize, rowCount - firstRow);
+        if (bitsetInterp) bitsetInterp->interpretBatch(input, output, firstRow, rows);
+        else interp.interpretBatch(input, output, firstRow, rows);
+    });
+}
@@ -0,0 +1,33 @@
+#ifndef BATCHEXECUTOR_H
+#define BATCHEXECUTOR_H
+
+#include "interpreter.h"
+#include "bitsetinterpreter.h"
+#include "workstealingpool.h"
+
+
+// Runs "Interpreter::interpretBatch()", or the same of "BitsetInterpreter", on all cores.
+// Rows are split into chunks; every chunk writes its own rows of the output block,
+// so results come out in input order without a separate merge step.
+class BatchExecutor
+{
+public:
+    // "Interpreter" must outlive the executor; "0" threads means one thread per core
+    explicit BatchExecutor(const Interpreter &interp, int threadCount = 0);
+    // Same with the engine testing many Rules at once; pays off for Rule Bases with long segments
+    explicit BatchExecutor(const BitsetInterpreter &bitsetInterp, int threadCount = 0);
+    
+public:
+    int getThreadCount() const;
+    
+    void interpretBatch(const Interpreter::BatchInput &input, Interpreter::BatchOutput &output, int chunkSize = 4096);
+    
+private:
+    const Interpreter &interp;
+    // "nullptr" if "interp" runs the rows
+    const BitsetInterpreter *bitsetInterp;
+    WorkStealingPool pool;
+    
+};
+
+#endif // BATCHEXECUTOR_H
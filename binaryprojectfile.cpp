@@ -0,0 +1,319 @@
+#include "binaryprojectfile.h"
+
+#include <QHash>
+#include <QSaveFile>
+
+#include <cstring>
+
+
+namespace
+{
+
+inline quint64 align8(quint64 offset)
+{
+    return (offset + 7) & ~static_cast<quint64>(7);
+}
+
+// Writes through a small buffer, so the File never has to fit into one QByteArray
+class SectionWriter
+{
+public:
+    explicit SectionWriter(QIODevice *device) : device(device), written(0), ok(true) {}
+    
+    void append(const char *bytes, qint64 length)
+    {
+        if (buffer.size() + length > bufferSize) flush();
+        if (length > bufferSize)
+        {
+            ok = ok && device->write(bytes, length) == length;
+        }
+        else
+        {
+            buffer.append(bytes, static_cast<int>(length));
+        }
+        written += static_cast<quint64>(length);
+    }
+    
+    void append32(quint32 number)
+    {
+        uchar bytes[4];
+        qToLittleEndian<quint32>(number, bytes);
+        append(reinterpret_cast<const char *>(bytes), 4);
+    }
+    
+    void append64(quint64 number)
+    {
+        uchar bytes[8];
+        qToLittleEndian<quint64>(number, bytes);
+        append(reinterpret_cast<const char *>(bytes), 8);
+    }
+    
+    void pad8()
+    {
+        static const char zeros[8] = {};
+        append(zeros, static_cast<qint64>(align8(written) - written));
+    }
+    
+    // Returns "false" if some write failed
+    bool flush()
+    {
+        if (!buffer.isEmpty()) ok = ok && device->write(buffer) == buffer.size();
+        buffer.clear();
+        return ok;
+    }
+    
+private:
+    static const int bufferSize = 1 << 16;
+    
+    QIODevice *device;
+    QByteArray buffer;
+    quint64 written;
+    bool ok;
+};
+
+// Interns every String once, in order of first use
+class StringTable
+{
+public:
+    quint32 intern(const QString &s)
+    {
+        auto it = ids.constFind(s);
+        if (it != ids.constEnd()) return it.value();
+        
+        quint32 id = static_cast<quint32>(strings.size());
+        ids.insert(s, id);
+        strings.append(s.toUtf8());
+        return id;
+    }
+    
+    QList<QByteArray> strings;
+    
+private:
+    QHash<QString, quint32> ids;
+};
+
+}
+
+const char BinaryProjectFile::magic[4] = {'E', 'S', 'B', '\0'};
+
+BinaryProjectFile::BinaryProjectFile() :
+    data(nullptr),
+    size(0),
+    stringCount(0),
+    varCount(0),
+    valueCount(0),
+    ruleCount(0),
+    pairCount(0),
+    projName(0)
+{
+    
+}
+
+BinaryProjectFile::~BinaryProjectFile()
+{
+    close();
+}
+
+bool BinaryProjectFile::isBinaryProjectFile(const QString &filePath)
+{
+    QFile f(filePath);
+    if (!f.open(QFile::ReadOnly)) return false;
+    
+    char head[4];
+    bool result = (f.read(head, 4) == 4 && memcmp(head, magic, 4) == 0);
+    f.close();
+    return result;
+}
+
+bool BinaryProjectFile::write(const QString &filePath, const QString &projName, const QStringList &varNames,
+                              const QList<QStringList> &varValues, const QList<Rule> &rules, quint64 revision)
+{
+    StringTable strings;
+    quint32 projNameString = strings.intern(projName);
+    
+    // Variables
+    std::vector<quint32> valueBegin(1, 0);
+    std::vector<quint32> nameTable;
+    std::vector<quint32> valueTable;
+    for (int i = 0; i < varNames.length(); i++)
+    {
+        nameTable.push_back(strings.intern(varNames.at(i)));
+        for (const QString &value : varValues.at(i))
+        {
+            valueTable.push_back(strings.intern(value));
+        }
+        valueBegin.push_back(static_cast<quint32>(valueTable.size()));
+    }
+    
+    // Rules
+    std::vector<quint32> pairBegin(1, 0);
+    std::vector<quint32> ifCounts;
+    std::vector<quint32> pairTable;
+    for (const Rule &rule : rules)
+    {
+        for (const Pair &ifPair : rule.ifBlock)
+        {
+            pairTable.push_back(strings.intern(ifPair.var));
+            pairTable.push_back(strings.intern(ifPair.value));
+        }
+        for (const Pair &thenPair : rule.thenBlock)
+        {
+            pairTable.push_back(strings.intern(thenPair.var));
+            pairTable.push_back(strings.intern(thenPair.value));
+        }
+        ifCounts.push_back(static_cast<quint32>(rule.ifBlock.length()));
+        pairBegin.push_back(static_cast<quint32>(pairTable.size() / 2));
+    }
+    
+    // Section offsets
+    quint64 stringTableSize = 4 * (static_cast<quint64>(strings.strings.size()) + 1);
+    for (const QByteArray &s : strings.strings)
+    {
+        stringTableSize += static_cast<quint64>(s.size());
+    }
+    quint64 stringOffset = headerSize;
+    quint64 varOffset = align8(stringOffset + stringTableSize);
+    quint64 ruleOffset = align8(varOffset + 4 * (valueBegin.size() + nameTable.size() + valueTable.size()));
+    quint64 fileSize = ruleOffset + 4 * (pairBegin.size() + ifCounts.size() + pairTable.size());
+    // String offsets and counts are 32-bit
+    if (fileSize > maxFileSize) return false;
+    
+    QSaveFile f(filePath);
+    if (!f.open(QSaveFile::WriteOnly | QSaveFile::Truncate)) return false;
+    SectionWriter out(&f);
+    
+    out.append(magic, 4);
+    out.append32(version);
+    out.append32(static_cast<quint32>(strings.strings.size()));
+    out.append32(static_cast<quint32>(nameTable.size()));
+    out.append32(static_cast<quint32>(valueTable.size()));
+    out.append32(static_cast<quint32>(ifCounts.size()));
+    out.append32(static_cast<quint32>(pairTable.size() / 2));
+    out.append32(projNameString);
+    out.append64(stringOffset);
+    out.append64(varOffset);
+    out.append64(ruleOffset);
+    out.append64(revision);
+    
+    quint32 offset = 0;
+    out.append32(offset);
+    for (const QByteArray &s : strings.strings)
+    {
+        offset += static_cast<quint32>(s.size());
+        out.append32(offset);
+    }
+    for (const QByteArray &s : strings.strings)
+    {
+        out.append(s.constData(), s.size());
+    }
+    out.pad8();
+    
+    for (quint32 n : valueBegin) out.append32(n);
+    for (quint32 n : nameTable) out.append32(n);
+    for (quint32 n : valueTable) out.append32(n);
+    out.pad8();
+    
+    for (quint32 n : pairBegin) out.append32(n);
+    for (quint32 n : ifCounts) out.append32(n);
+    for (quint32 n : pairTable) out.append32(n);
+    
+    if (!out.flush()) return false;
+    return f.commit();
+}
+
+bool BinaryProjectFile::open(const QString &filePath)
+{
+    close();
+    
+    file.setFileName(filePath);
+    if (!file.open(QFile::ReadOnly)) return false;
+    
+    size = static_cast<quint64>(file.size());
+    if (size < static_cast<quint64>(headerSize)) return fail();
+    data = file.map(0, file.size());
+    if (!data) return fail();
+    
+    if (memcmp(data, magic, 4) != 0 || read32(data, 1) != version) return fail();
+    stringCount = read32(data, 2);
+    varCount = read32(data, 3);
+    valueCount = read32(data, 4);
+    ruleCount = read32(data, 5);
+    pairCount = read32(data, 6);
+    projName = read32(data, 7);
+    quint64 stringOffset = qFromLittleEndian<quint64>(data + 32);
+    quint64 varOffset = qFromLittleEndian<quint64>(data + 40);
+    quint64 ruleOffset = qFromLittleEndian<quint64>(data + 48);
+    
+    // Sections must fit into the File; counts are 32-bit, so the sums below do not overflow
+    quint64 stringIndexSize = 4 * (static_cast<quint64>(stringCount) + 1);
+    quint64 varSize = 4 * (2 * static_cast<quint64>(varCount) + 1 + valueCount);
+    quint64 ruleSize = 4 * (2 * static_cast<quint64>(ruleCount) + 1 + 2 * static_cast<quint64>(pairCount));
+    if (stringOffset > size || stringIndexSize > size - stringOffset) return fail();
+    if (varOffset > size || varSize > size - varOffset) return fail();
+    if (ruleOffset > size || ruleSize > size - ruleOffset) return fail();
+    
+    stringOffsetTable = data + stringOffset;
+    stringData = stringOffsetTable + stringIndexSize;
+    valueBeginTable = data + varOffset;
+    varNameTable = valueBeginTable + 4 * (static_cast<quint64>(varCount) + 1);
+    valueTable = varNameTable + 4 * static_cast<quint64>(varCount);
+    pairBeginTable = data + ruleOffset;
+    ifCountTable = pairBeginTable + 4 * (static_cast<quint64>(ruleCount) + 1);
+    pairTable = ifCountTable + 4 * static_cast<quint64>(ruleCount);
+    
+    // Indices must be monotonic and refer to existing entries, so the Getters need no checks
+    quint64 stringDataSize = size - stringOffset - stringIndexSize;
+    if (read32(stringOffsetTable, 0) != 0) return fail();
+    for (quint32 i = 0; i < stringCount; i++)
+    {
+        if (read32(stringOffsetTable, i + 1) < read32(stringOffsetTable, i)) return fail();
+    }
+    if (read32(stringOffsetTable, stringCount) > stringDataSize) return fail();
+    if (projName >= stringCount) return fail();
+    
+    if (read32(valueBeginTable, 0) != 0 || read32(valueBeginTable, varCount) != valueCount) return fail();
+    for (quint32 i = 0; i < varCount; i++)
+    {
+        if (read32(valueBeginTable, i + 1) < read32(valueBeginTable, i)) return fail();
+        if (read32(varNameTable, i) >= stringCount) return fail();
+    }
+    for (quint32 i = 0; i < valueCount; i++)
+    {
+        if (read32(valueTable, i) >= stringCount) return fail();
+    }
+    
+    if (read32(pairBeginTable, 0) != 0 || read32(pairBeginTable, ruleCount) != pairCount) return fail();
+    for (quint32 i = 0; i < ruleCount; i++)
+    {
+        if (read32(pairBeginTable, i + 1) < read32(pairBeginTable, i)) return fail();
+        if (read32(ifCountTable, i) > read32(pairBeginTable, i + 1) - read32(pairBeginTable, i)) return fail();
+    }
+    for (quint64 i = 0; i < 2 * static_cast<quint64>(pairCount); i++)
+    {
+        if (read32(pairTable, static_cast<quint32>(i)) >= stringCount) return fail();
+    }
+    
+    return true;
+}
+
+void BinaryProjectFile::close()
+{
+    if (data) file.unmap(const_cast<uchar *>(data));
+    file.close();
+    data = nullptr;
+    size = 0;
+    stringCount = varCount = valueCount = ruleCount = pairCount = projName = 0;
+}
+
+bool BinaryProjectFile::fail()
+{
+    close();
+    return false;
+}
+
+QString BinaryProjectFile::getString(int stringId) const
+{
+    quint32 begin = read32(stringOffsetTable, static_cast<quint32>(stringId));
+    quint32 end = read32(stringOffsetTable, static_cast<quint32>(stringId) + 1);
+    return QString::fromUtf8(reinterpret_cast<const char *>(stringData + begin), static_cast<int>(end - begin));
+}
@@ -0,0 +1,96 @@
+#ifndef BINARYPROJECTFILE_H
+#define BINARYPROJECTFILE_H
+
+#include "project.h"
+
+#include <QFile>
+#include <QtEndian>
+
+#include <vector>
+
+
+// Read-only view of a binary Project File (".esb"), memory-mapped as a whole.
+// All numbers are little-endian "quint32"/"quint64"; every section starts at a multiple of 8:
+//  - header (64 bytes): magic, version, counts, Project Name String, section offsets, Project revision;
+//  - String table: "stringCount + 1" offsets into UTF-8 data, String "s" is [offset[s], offset[s + 1]);
+//  - Variables: "varCount + 1" first Value indices, "varCount" Name Strings, "valueCount" Value Strings;
+//  - Rules: "ruleCount + 1" first Pair indices, "ruleCount" IF-Pair counts,
+//    "pairCount" Pair records of two Strings (Variable, Value); IF-Pairs of a Rule come first.
+// Pairs refer to Strings rather than to Variables, so Rules using undeclared names are kept as is.
+// Loading a Project still copies everything into its editable Lists; mapping spares reading and tokenizing
+// the text and converts every distinct String only once. Read-only users may use the view directly.
+class BinaryProjectFile
+{
+public:
+    BinaryProjectFile();
+    ~BinaryProjectFile();
+    
+    // Checks the magic only
+    static bool isBinaryProjectFile(const QString &filePath);
+    // Writes the Project section by section; returns "false" if the File can not be written
+    // or would be larger than "maxFileSize"
+    static bool write(const QString &filePath, const QString &projName, const QStringList &varNames,
+                      const QList<QStringList> &varValues, const QList<Rule> &rules, quint64 revision);
+    
+    // Maps the File and validates all offsets; returns "false" if it is not a valid binary Project File
+    bool open(const QString &filePath);
+    void close();
+    
+    
+    // Getters; ids are not checked beyond "open"
+    
+    inline int getStringCount() const { return static_cast<int>(stringCount); }
+    QString getString(int stringId) const;
+    
+    inline int getProjName() const { return static_cast<int>(projName); }
+    // Revision of the Project when the File was written, see "ProjectJournal"
+    inline quint64 getRevision() const { return qFromLittleEndian<quint64>(data + 56); }
+    
+    inline int getVarCount() const { return static_cast<int>(varCount); }
+    inline int getVarName(int varId) const { return static_cast<int>(read32(varNameTable, varId)); }
+    inline int getValueCount(int varId) const { return static_cast<int>(read32(valueBeginTable, varId + 1) - read32(valueBeginTable, varId)); }
+    inline int getValue(int varId, int valueId) const { return static_cast<int>(read32(valueTable, read32(valueBeginTable, varId) + valueId)); }
+    
+    inline int getRuleCount() const { return static_cast<int>(ruleCount); }
+    inline int getIfPairCount(int ruleId) const { return static_cast<int>(read32(ifCountTable, ruleId)); }
+    inline int getPairCount(int ruleId) const { return static_cast<int>(read32(pairBeginTable, ruleId + 1) - read32(pairBeginTable, ruleId)); }
+    // Pairs "0 .. getIfPairCount() - 1" are IF-Pairs, the rest are THEN-Pairs
+    inline int getPairVar(int ruleId, int pairId) const { return static_cast<int>(read32(pairTable, 2 * (read32(pairBeginTable, ruleId) + pairId))); }
+    inline int getPairValue(int ruleId, int pairId) const { return static_cast<int>(read32(pairTable, 2 * (read32(pairBeginTable, ruleId) + pairId) + 1)); }
+    
+    static const char magic[4];
+    static const quint32 version = 1;
+    static const int headerSize = 64;
+    // String offsets, counts and indices are 32-bit
+    static const quint64 maxFileSize = Q_UINT64_C(0xffffffff);
+    
+private:
+    // Closes the File and returns "false"
+    bool fail();
+    
+    static inline quint32 read32(const uchar *table, quint32 index) { return qFromLittleEndian<quint32>(table + 4 * static_cast<quintptr>(index)); }
+    
+private:
+    QFile file;
+    const uchar *data;
+    quint64 size;
+    
+    quint32 stringCount;
+    quint32 varCount;
+    quint32 valueCount;
+    quint32 ruleCount;
+    quint32 pairCount;
+    quint32 projName;
+    
+    const uchar *stringOffsetTable;
+    const uchar *stringData;
+    const uchar *valueBeginTable;
+    const uchar *varNameTable;
+    const uchar *valueTable;
+    const uchar *pairBeginTable;
+    const uchar *ifCountTable;
+    const uchar *pairTable;
+    
+};
+
+#endif // BINARYPROJECTFILE_H
@@ -0,0 +1,261 @@
+#include "bitsetinterpreter.h"
+
+#include <QtAlgorithms>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+BitsetInterpreter::BitsetInterpreter(const QStringList &varNames, const QList<QStringList> &varValues, const QList<Rule> &rules) :
+    interp(varNames, varValues, rules),
+    maxWords(0)
+{
+    initialize();
+}
+
+const QStringList &BitsetInterpreter::getRequiredInputVarList() const
+{
+    return interp.getRequiredInputVarList();
+}
+
+const QStringList &BitsetInterpreter::getOutputVarList() const
+{
+    return interp.getOutputVarList();
+}
+
+const QList<int> &BitsetInterpreter::getUnreachableRuleList() const
+{
+    return interp.getUnreachableRuleList();
+}
+
+QMap<QString, QString> BitsetInterpreter::interpret(const QMap<QString, QString> &input) const
+{
+    const SymbolTable &symbols = interp.getSymbols();
+    
+    std::vector<quint16> memory(symbols.getVarCount(), 0);
+    std::vector<quint64> fired(maxWords);
+    
+    for (auto it = input.constBegin(); it != input.constEnd(); ++it)
+    {
+        int varId = symbols.getVarId(it.key());
+        if (varId == -1) continue;
+        memory[varId] = symbols.getValueCode(varId, it.value());
+    }
+    
+    run(memory, fired);
+    
+    QMap<QString, QString> output;
+    for (int varId : interp.getOutputVarIds())
+    {
+        output[symbols.getVarName(varId)] = symbols.getValueName(varId, memory[varId]);
+    }
+    
+    return output;
+}
+
+QStringList BitsetInterpreter::interpretAndStringify(const QMap<QString, QString> &input) const
+{
+    auto output = interpret(input);
+    
+    QStringList result;
+    
+    foreach (auto key, output.keys())
+    {
+        result.append(key + " <= " + output.value(key));
+    }
+    
+    return result;
+}
+
+void BitsetInterpreter::interpretBatch(const Interpreter::BatchInput &input, Interpreter::BatchOutput &output, int firstRow, int rowCount) const
+{
+    if (rowCount == -1) rowCount = input.rowCount - firstRow;
+    
+    const std::vector<int> &inputVarIds = interp.getInputVarIds();
+    const std::vector<int> &outputVarIds = interp.getOutputVarIds();
+    int inputCount = static_cast<int>(inputVarIds.size());
+    int outputCount = static_cast<int>(outputVarIds.size());
+    
+    std::vector<quint16> memory(interp.getSymbols().getVarCount(), 0);
+    std::vector<quint64> fired(maxWords);
+    
+    for (int row = firstRow; row < firstRow + rowCount; row++)
+    {
+        for (int varId : assignedVarIds)
+        {
+            memory[varId] = 0;
+        }
+        
+        for (int k = 0; k < inputCount; k++)
+        {
+            memory[inputVarIds[k]] = input.columns[k][row];
+        }
+        
+        run(memory, fired);
+        
+        for (int k = 0; k < outputCount; k++)
+        {
+            output.columns[k][row] = memory[outputVarIds[k]];
+        }
+    }
+}
+
+const Interpreter &BitsetInterpreter::getInterpreter() const
+{
+    return interp;
+}
+
+int BitsetInterpreter::getSegmentCount() const
+{
+    return static_cast<int>(segments.size());
+}
+
+void BitsetInterpreter::initialize()
+{
+    const RuleProgram &program = interp.getProgram();
+    const SymbolTable &symbols = interp.getSymbols();
+    int ruleCount = program.getRuleCount();
+    int varCount = symbols.getVarCount();
+    
+    // Stamps hold "segment index + 1"
+    std::vector<int> writeStamp(varCount, 0);
+    std::vector<int> readStamp(varCount, 0);
+    
+    // Splitting Rules into segments
+    std::vector<quint32> segmentStarts;
+    for (int r = 0; r < ruleCount; r++)
+    {
+        bool readsAssigned = segmentStarts.empty() || (static_cast<quint32>(r) - segmentStarts.back() == maxSegmentRules);
+        for (quint32 i = program.ifBegin[r]; i < program.ifBegin[r + 1]; i++)
+        {
+            if (writeStamp[program.ifVars[i]] == static_cast<int>(segmentStarts.size())) readsAssigned = true;
+        }
+        if (readsAssigned) segmentStarts.push_back(static_cast<quint32>(r));
+        
+        for (quint32 j = program.thenBegin[r]; j < program.thenBegin[r + 1]; j++)
+        {
+            writeStamp[program.thenVars[j]] = static_cast<int>(segmentStarts.size());
+        }
+    }
+    segmentStarts.push_back(static_cast<quint32>(ruleCount));
+    
+    // Filling bitsets
+    for (int s = 0; s + 1 < static_cast<int>(segmentStarts.size()); s++)
+    {
+        Segment segment;
+        segment.firstRule = segmentStarts[s];
+        segment.ruleCount = segmentStarts[s + 1] - segmentStarts[s];
+        segment.varBegin = static_cast<quint32>(segmentVars.size());
+        
+        int words = (static_cast<int>(segment.ruleCount) + 63) / 64;
+        words = (words + wordStep - 1) / wordStep * wordStep;
+        if (words > maxWords) maxWords = words;
+        
+        for (quint32 k = 0; k < segment.ruleCount; k++)
+        {
+            quint32 r = segment.firstRule + k;
+            for (quint32 i = program.ifBegin[r]; i < program.ifBegin[r + 1]; i++)
+            {
+                quint32 varId = program.ifVars[i];
+                if (readStamp[varId] == s + 1) continue;
+                readStamp[varId] = s + 1;
+                
+                // All Rules accept every Value at first
+                int rows = symbols.getDomainSize(varId) + 2;
+                segmentVars.push_back(varId);
+                segmentRows.push_back(static_cast<quint32>(masks.size()));
+                masks.resize(masks.size() + rows * words, ~quint64(0));
+            }
+        }
+        segment.varEnd = static_cast<quint32>(segmentVars.size());
+        
+        // Every IF-Pair rejects all Values but its own
+        for (quint32 k = 0; k < segment.ruleCount; k++)
+        {
+            quint32 r = segment.firstRule + k;
+            for (quint32 i = program.ifBegin[r]; i < program.ifBegin[r + 1]; i++)
+            {
+                quint32 v = segment.varBegin;
+                while (segmentVars[v] != program.ifVars[i]) v++;
+                
+                quint64 *first = masks.data() + segmentRows[v];
+                int rows = symbols.getDomainSize(program.ifVars[i]) + 2;
+                for (int c = 0; c < rows; c++)
+                {
+                    if (c != program.ifValues[i]) first[c * words + k / 64] &= ~(quint64(1) << (k % 64));
+                }
+            }
+        }
+        
+        segments.push_back(segment);
+    }
+    
+    std::vector<bool> assigned(varCount, false);
+    for (quint32 varId : program.thenVars)
+    {
+        if (assigned[varId]) continue;
+        assigned[varId] = true;
+        assignedVarIds.push_back(static_cast<int>(varId));
+    }
+}
+
+void BitsetInterpreter::run(std::vector<quint16> &memory, std::vector<quint64> &fired) const
+{
+    const RuleProgram &program = interp.getProgram();
+    const SymbolTable &symbols = interp.getSymbols();
+    quint16 *mem = memory.data();
+    quint64 *bits = fired.data();
+    
+    for (const Segment &segment : segments)
+    {
+        int words = (static_cast<int>(segment.ruleCount) + 63) / 64;
+        int paddedWords = (words + wordStep - 1) / wordStep * wordStep;
+        
+        for (int w = 0; w < paddedWords; w++)
+        {
+            bits[w] = ~quint64(0);
+        }
+        
+        for (quint32 v = segment.varBegin; v < segment.varEnd; v++)
+        {
+            quint32 varId = segmentVars[v];
+            quint32 code = mem[varId];
+            quint32 domainSize = static_cast<quint32>(symbols.getDomainSize(varId));
+            if (code > domainSize) code = domainSize + 1;
+            
+            const quint64 *row = masks.data() + segmentRows[v] + code * paddedWords;
+#ifdef __AVX2__
+            for (int w = 0; w < paddedWords; w += wordStep)
+            {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bits + w));
+                __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + w));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(bits + w), _mm256_and_si256(a, b));
+            }
+#else
+            for (int w = 0; w < paddedWords; w++)
+            {
+                bits[w] &= row[w];
+            }
+#endif
+        }
+        
+        // Assignments go in Rule order, so the last fired Rule wins as in "Interpreter"
+        for (int w = 0; w < words; w++)
+        {
+            quint64 word = bits[w];
+            if (w == words - 1 && segment.ruleCount % 64 != 0) word &= (quint64(1) << (segment.ruleCount % 64)) - 1;
+            
+            while (word != 0)
+            {
+                int bit = static_cast<int>(qCountTrailingZeroBits(word));
+                word &= word - 1;
+                
+                quint32 r = segment.firstRule + static_cast<quint32>(w * 64 + bit);
+                for (quint32 j = program.thenBegin[r]; j < program.thenBegin[r + 1]; j++)
+                {
+                    mem[program.thenVars[j]] = program.thenValues[j];
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef BITSETINTERPRETER_H
+#define BITSETINTERPRETER_H
+
+#include "interpreter.h"
+
+#include <vector>
+
+
+// Evaluates the same program as "Interpreter", but tests conditions of many Rules at once.
+// Rules are grouped into segments where no Rule reads a Variable assigned earlier in the segment,
+// so all conditions of a segment can be tested on the memory it starts with.
+// For every Variable tested in a segment and every Value there is a bitset of Rules that accept it
+// (Rules without IF-Pair on the Variable accept any Value); Rules that fire are the AND of these bitsets,
+// computed with AVX2 when the compiler targets it. Fired Rules then assign their THEN-Pairs in order.
+class BitsetInterpreter
+{
+public:
+    BitsetInterpreter(const QStringList &varNames, const QList<QStringList> &varValues, const QList<Rule> &rules);
+    
+public:
+    const QStringList &getRequiredInputVarList() const;
+    const QStringList &getOutputVarList() const;
+    const QList<int> &getUnreachableRuleList() const;
+    QMap<QString, QString> interpret(const QMap<QString, QString> &input) const;
+    QStringList interpretAndStringify(const QMap<QString, QString> &input) const;
+    // Same layout as "Interpreter::interpretBatch()"
+    void interpretBatch(const Interpreter::BatchInput &input, Interpreter::BatchOutput &output, int firstRow = 0, int rowCount = -1) const;
+    
+    const Interpreter &getInterpreter() const;
+    int getSegmentCount() const;
+    
+private:
+    struct Segment
+    {
+        // Rules [firstRule, firstRule + ruleCount) of the program
+        quint32 firstRule;
+        quint32 ruleCount;
+        // Tested Variables are [varBegin, varEnd) of "segmentVars" and "segmentRows"
+        quint32 varBegin;
+        quint32 varEnd;
+    };
+    
+private:
+    void initialize();
+    void run(std::vector<quint16> &memory, std::vector<quint64> &fired) const;
+    
+private:
+    Interpreter interp;
+    
+    // Bitsets are padded to "wordStep" words, so the SIMD loop has no tail
+    static const int wordStep = 4;
+    // Longer segments are split to keep bitsets of rarely tested Variables small
+    static const quint32 maxSegmentRules = 1024;
+    
+    std::vector<Segment> segments;
+    std::vector<quint32> segmentVars;
+    // Offset of the first bitset of the Variable in "masks"; bitset of Value code "c"
+    // follows after "c" bitsets, code "domain size + 1" stands for codes out of the domain
+    std::vector<quint32> segmentRows;
+    std::vector<quint64> masks;
+    int maxWords;
+    
+    std::vector<int> assignedVarIds;
+    
+};
+
+#endif // BITSETINTERPRETER_H
@@ -0,0 +1,317 @@
+#include "decisiondiagram.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+
+
+DecisionDiagram::DecisionDiagram(const Interpreter &interp, int maxNodes) :
+    interp(interp),
+    maxNodes(maxNodes),
+    failed(false),
+    compileTime(0),
+    nodeCount(-1)
+{
+    QElapsedTimer timer;
+    timer.start();
+    
+    compile();
+    
+    // Tables needed only while compiling
+    uniqueNodes.clear();
+    computed.clear();
+    
+    compileTime = timer.elapsed();
+}
+
+bool DecisionDiagram::isCompiled() const
+{
+    return !failed;
+}
+
+int DecisionDiagram::getNodeCount() const
+{
+    return nodeCount;
+}
+
+qint64 DecisionDiagram::getCompileTime() const
+{
+    return compileTime;
+}
+
+QMap<QString, QString> DecisionDiagram::interpret(const QMap<QString, QString> &input) const
+{
+    if (failed) return interp.interpret(input);
+    
+    const SymbolTable &symbols = interp.getSymbols();
+    const std::vector<int> &inputVarIds = interp.getInputVarIds();
+    const std::vector<int> &outputVarIds = interp.getOutputVarIds();
+    
+    std::vector<quint16> inputCodes(inputVarIds.size(), 0);
+    int found = 0;
+    for (int k = 0; k < static_cast<int>(inputVarIds.size()); k++)
+    {
+        auto it = input.constFind(symbols.getVarName(inputVarIds[k]));
+        if (it == input.constEnd()) continue;
+        inputCodes[k] = symbols.getValueCode(inputVarIds[k], it.value());
+        found++;
+    }
+    
+    // Preset Values of other known Variables are not covered by the diagram
+    if (found != input.size())
+    {
+        for (auto it = input.constBegin(); it != input.constEnd(); ++it)
+        {
+            int varId = symbols.getVarId(it.key());
+            if (varId == -1) continue;
+            if (std::find(inputVarIds.begin(), inputVarIds.end(), varId) == inputVarIds.end()) return interp.interpret(input);
+        }
+    }
+    
+    std::vector<quint16> outputCodes(outputVarIds.size());
+    walk(inputCodes, outputCodes);
+    
+    QMap<QString, QString> output;
+    for (int k = 0; k < static_cast<int>(outputVarIds.size()); k++)
+    {
+        output[symbols.getVarName(outputVarIds[k])] = symbols.getValueName(outputVarIds[k], outputCodes[k]);
+    }
+    
+    return output;
+}
+
+QStringList DecisionDiagram::interpretAndStringify(const QMap<QString, QString> &input) const
+{
+    auto output = interpret(input);
+    
+    QStringList result;
+    
+    foreach (auto key, output.keys())
+    {
+        result.append(key + " <= " + output.value(key));
+    }
+    
+    return result;
+}
+
+void DecisionDiagram::interpretBatch(const Interpreter::BatchInput &input, Interpreter::BatchOutput &output, int firstRow, int rowCount) const
+{
+    if (failed)
+    {
+        interp.interpretBatch(input, output, firstRow, rowCount);
+        return;
+    }
+    
+    if (rowCount == -1) rowCount = input.rowCount - firstRow;
+    
+    int inputCount = static_cast<int>(radixes.size());
+    int outputCount = static_cast<int>(output.columns.size());
+    
+    std::vector<quint16> inputCodes(inputCount);
+    std::vector<quint16> outputCodes(outputCount);
+    
+    for (int row = firstRow; row < firstRow + rowCount; row++)
+    {
+        bool inDomain = true;
+        for (int k = 0; k < inputCount; k++)
+        {
+            inputCodes[k] = input.columns[k][row];
+            if (inputCodes[k] >= radixes[k]) inDomain = false;
+        }
+        
+        // Codes out of the domain have no branch
+        if (!inDomain)
+        {
+            interp.interpretBatch(input, output, row, 1);
+            continue;
+        }
+        
+        walk(inputCodes, outputCodes);
+        
+        for (int k = 0; k < outputCount; k++)
+        {
+            output.columns[k][row] = outputCodes[k];
+        }
+    }
+}
+
+void DecisionDiagram::compile()
+{
+    const SymbolTable &symbols = interp.getSymbols();
+    const RuleProgram &program = interp.getProgram();
+    const std::vector<int> &inputVarIds = interp.getInputVarIds();
+    
+    leafLevel = static_cast<int>(inputVarIds.size());
+    for (int varId : inputVarIds)
+    {
+        radixes.push_back(static_cast<quint32>(symbols.getDomainSize(varId)) + 1);
+    }
+    
+    // Value of every Variable as a diagram; unassigned Variables are unset
+    std::vector<int> current(symbols.getVarCount(), makeLeaf(0));
+    for (int k = 0; k < leafLevel; k++)
+    {
+        std::vector<int> values;
+        for (quint32 c = 0; c < radixes[k]; c++)
+        {
+            values.push_back(makeLeaf(static_cast<quint16>(c)));
+        }
+        current[inputVarIds[k]] = makeNode(k, values);
+    }
+    
+    const int falseLeaf = makeLeaf(0);
+    const int trueLeaf = makeLeaf(1);
+    
+    for (int r = 0; r < program.getRuleCount() && !failed; r++)
+    {
+        int condition = trueLeaf;
+        for (quint32 i = program.ifBegin[r]; i < program.ifBegin[r + 1] && condition != falseLeaf; i++)
+        {
+            int equals = apply(Operation::Equals, current[program.ifVars[i]], -1, program.ifValues[i]);
+            condition = apply(Operation::And, condition, equals, -1);
+        }
+        if (failed || condition == falseLeaf) continue;
+        
+        for (quint32 j = program.thenBegin[r]; j < program.thenBegin[r + 1]; j++)
+        {
+            int &value = current[program.thenVars[j]];
+            value = apply(Operation::IfThenElse, condition, makeLeaf(program.thenValues[j]), value);
+        }
+        
+        // Results of old operations are rarely needed again
+        if (computed.size() > maxNodes) computed.clear();
+    }
+    
+    if (failed) return;
+    
+    for (int varId : interp.getOutputVarIds())
+    {
+        roots.push_back(current[varId]);
+    }
+    
+    // Counting reachable nodes
+    std::vector<bool> visited(nodeLevels.size(), false);
+    std::vector<int> stack(roots.begin(), roots.end());
+    nodeCount = 0;
+    while (!stack.empty())
+    {
+        int node = stack.back();
+        stack.pop_back();
+        if (visited[node]) continue;
+        visited[node] = true;
+        nodeCount++;
+        
+        if (isLeaf(node)) continue;
+        for (quint32 c = 0; c < radixes[nodeLevels[node]]; c++)
+        {
+            stack.push_back(children[nodeChildren[node] + c]);
+        }
+    }
+}
+
+int DecisionDiagram::makeLeaf(quint16 value)
+{
+    if (value >= leaves.size()) leaves.resize(value + 1, -1);
+    
+    if (leaves[value] == -1)
+    {
+        leaves[value] = static_cast<int>(nodeLevels.size());
+        nodeLevels.push_back(leafLevel);
+        nodeChildren.push_back(value);
+    }
+    
+    return leaves[value];
+}
+
+int DecisionDiagram::makeNode(int level, const std::vector<int> &nodeChildList)
+{
+    // Node with equal children is redundant
+    if (std::all_of(nodeChildList.begin(), nodeChildList.end(), [&](int child) { return child == nodeChildList[0]; }))
+    {
+        return nodeChildList[0];
+    }
+    
+    QByteArray key(reinterpret_cast<const char *>(&level), sizeof(level));
+    key.append(reinterpret_cast<const char *>(nodeChildList.data()), static_cast<int>(nodeChildList.size() * sizeof(int)));
+    
+    auto it = uniqueNodes.constFind(key);
+    if (it != uniqueNodes.constEnd()) return it.value();
+    
+    if (static_cast<int>(nodeLevels.size()) >= maxNodes)
+    {
+        failed = true;
+        return -1;
+    }
+    
+    int node = static_cast<int>(nodeLevels.size());
+    nodeLevels.push_back(level);
+    nodeChildren.push_back(static_cast<quint32>(children.size()));
+    children.insert(children.end(), nodeChildList.begin(), nodeChildList.end());
+    uniqueNodes.insert(key, node);
+    
+    return node;
+}
+
+int DecisionDiagram::apply(Operation op, int f, int g, int h)
+{
+    if (failed) return -1;
+    
+    // Terminal cases
+    switch (op) {
+    case Operation::Equals:
+        if (isLeaf(f)) return makeLeaf(nodeChildren[f] == static_cast<quint32>(h) ? 1 : 0);
+        break;
+    case Operation::And:
+        if (f == makeLeaf(0) || g == makeLeaf(0)) return makeLeaf(0);
+        if (f == makeLeaf(1) || f == g) return g;
+        if (g == makeLeaf(1)) return f;
+        break;
+    case Operation::IfThenElse:
+        if (isLeaf(f)) return (nodeChildren[f] != 0) ? g : h;
+        if (g == h) return g;
+        break;
+    }
+    
+    int operands[4] = {static_cast<int>(op), f, g, h};
+    QByteArray key(reinterpret_cast<const char *>(operands), sizeof(operands));
+    auto it = computed.constFind(key);
+    if (it != computed.constEnd()) return it.value();
+    
+    // Operands of "Equals" and the Value operands of "IfThenElse" may be leaves
+    int level = nodeLevels[f];
+    if (op != Operation::Equals)
+    {
+        level = qMin(level, nodeLevels[g]);
+        if (op == Operation::IfThenElse) level = qMin(level, nodeLevels[h]);
+    }
+    
+    std::vector<int> nodeChildList(radixes[level]);
+    for (quint32 c = 0; c < radixes[level]; c++)
+    {
+        int cf = cofactor(f, level, c);
+        int cg = (op == Operation::Equals) ? g : cofactor(g, level, c);
+        int ch = (op == Operation::IfThenElse) ? cofactor(h, level, c) : h;
+        
+        nodeChildList[c] = apply(op, cf, cg, ch);
+        if (failed) return -1;
+    }
+    
+    int result = makeNode(level, nodeChildList);
+    if (failed) return -1;
+    
+    computed.insert(key, result);
+    return result;
+}
+
+void DecisionDiagram::walk(const std::vector<quint16> &inputCodes, std::vector<quint16> &outputCodes) const
+{
+    for (int k = 0; k < static_cast<int>(roots.size()); k++)
+    {
+        int node = roots[k];
+        while (nodeLevels[node] != leafLevel)
+        {
+            node = children[nodeChildren[node] + inputCodes[nodeLevels[node]]];
+        }
+        outputCodes[k] = static_cast<quint16>(nodeChildren[node]);
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef DECISIONDIAGRAM_H
+#define DECISIONDIAGRAM_H
+
+#include "interpreter.h"
+
+#include <QHash>
+#include <QByteArray>
+
+#include <vector>
+
+
+// Every Output Variable compiled into a reduced ordered multi-valued decision diagram over the Input Variables.
+// The Rules are executed symbolically in evaluation order: the Value of every Variable is a diagram,
+// an IF-block becomes a Boolean diagram and a THEN-Pair an if-then-else over them; all diagrams share nodes.
+// Interpretation is a walk from the root to a leaf with at most one step per Input Variable.
+// When the diagram needs more nodes than allowed, compiling stops and the Interpreter is used directly.
+class DecisionDiagram
+{
+public:
+    // "Interpreter" must outlive the diagram
+    explicit DecisionDiagram(const Interpreter &interp, int maxNodes = 1 << 20);
+    
+public:
+    bool isCompiled() const;
+    // Nodes reachable from the Output roots, leaves included; "-1" if not compiled
+    int getNodeCount() const;
+    // Milliseconds spent on compiling, also when it was given up
+    qint64 getCompileTime() const;
+    
+    QMap<QString, QString> interpret(const QMap<QString, QString> &input) const;
+    QStringList interpretAndStringify(const QMap<QString, QString> &input) const;
+    // Same layout as "Interpreter::interpretBatch()"
+    void interpretBatch(const Interpreter::BatchInput &input, Interpreter::BatchOutput &output, int firstRow = 0, int rowCount = -1) const;
+    
+private:
+    enum class Operation : char
+    {
+        // Boolean diagram of "f == h"
+        Equals,
+        // Boolean "f && g"
+        And,
+        // "f ? g : h" for Boolean "f"
+        IfThenElse
+    };
+    
+private:
+    void compile();
+    
+    int makeLeaf(quint16 value);
+    // Node testing Input Variable number "level"; "nodeChildList" has one entry per Value code
+    int makeNode(int level, const std::vector<int> &nodeChildList);
+    int apply(Operation op, int f, int g, int h);
+    
+    inline bool isLeaf(int node) const { return nodeLevels[node] == leafLevel; }
+    inline int cofactor(int node, int level, int code) const
+    {
+        return (nodeLevels[node] == level) ? children[nodeChildren[node] + code] : node;
+    }
+    
+    // Output codes in the order of "Interpreter::getOutputVarIds()"
+    void walk(const std::vector<quint16> &inputCodes, std::vector<quint16> &outputCodes) const;
+    
+private:
+    const Interpreter &interp;
+    int maxNodes;
+    bool failed;
+    qint64 compileTime;
+    int nodeCount;
+    
+    // Input Variables in the order of "Interpreter::getInputVarIds()" are the levels of the diagram;
+    // leaves have level "leafLevel" and keep their Value code in "nodeChildren"
+    int leafLevel;
+    std::vector<quint32> radixes;
+    std::vector<int> nodeLevels;
+    std::vector<quint32> nodeChildren;
+    std::vector<int> children;
+    std::vector<int> roots;
+    
+    std::vector<int> leaves;
+    QHash<QByteArray, int> uniqueNodes;
+    QHash<QByteArray, int> computed;
+    
+};
+
+#endif // DECISIONDIAGRAM_H
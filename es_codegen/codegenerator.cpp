@@ -0,0 +1,272 @@
+#include "codegenerator.h"
+
+
+namespace
+{
+
+template <typename T>
+void appendTable(QString *result, const QString &type, const QString &name, const std::vector<T> &table)
+{
+    result->append("constexpr " + type + " " + name + "[] = {");
+    for (size_t i = 0; i < table.size(); i++)
+    {
+        result->append((i > 0 ? ", " : "") + QString::number(table[i]));
+    }
+    // Empty arrays are not allowed
+    if (table.empty()) result->append("0");
+    result->append("};\n");
+}
+    
+}
+
+// C++17 keywords and alternative tokens, plus names the generated header uses itself
+static const char *const reservedWords[] =
+{
+    "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case", "catch",
+    "char", "char16_t", "char32_t", "class", "compl", "const", "constexpr", "const_cast", "continue", "decltype",
+    "default", "delete", "do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false",
+    "float", "for", "friend", "goto", "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept",
+    "not", "not_eq", "nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register",
+    "reinterpret_cast", "return", "short", "signed", "sizeof", "static", "static_assert", "static_cast", "struct",
+    "switch", "template", "this", "thread_local", "throw", "true", "try", "typedef", "typeid", "typename", "union",
+    "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while",
+    "std", "value", "Input", "Output", "evaluate", "toString", "rules"
+};
+
+CodeGenerator::CodeGenerator(const Interpreter &interp, const QString &projName) :
+    interp(interp),
+    projName(projName)
+{
+    QSet<QString> reserved;
+    for (const char *word : reservedWords)
+    {
+        reserved.insert(word);
+    }
+    
+    QSet<QString> taken = reserved;
+    namespaceName = makeIdentifier("es_" + projName, &taken);
+    
+    const SymbolTable &symbols = interp.getSymbols();
+    
+    taken = reserved;
+    for (int v = 0; v < symbols.getVarCount(); v++)
+    {
+        // "<identifier>_names" holds the Value names, so it must be free as well
+        varIdentifiers.append(makeIdentifier(symbols.getVarName(v), &taken, "names"));
+    }
+    
+    for (int v = 0; v < symbols.getVarCount(); v++)
+    {
+        QSet<QString> valuesTaken = reserved;
+        valuesTaken.insert("unset_");
+        QStringList values;
+        values.append("unset_");
+        for (int c = 1; c <= symbols.getDomainSize(v); c++)
+        {
+            values.append(makeIdentifier(symbols.getValueName(v, static_cast<quint16>(c)), &valuesTaken));
+        }
+        valueIdentifiers.append(values);
+    }
+}
+
+QString CodeGenerator::generateHeader() const
+{
+    const SymbolTable &symbols = interp.getSymbols();
+    const RuleProgram &program = interp.getProgram();
+    const std::vector<int> &inputVarIds = interp.getInputVarIds();
+    const std::vector<int> &outputVarIds = interp.getOutputVarIds();
+    int varCount = symbols.getVarCount();
+    
+    // No "__" in the guard either
+    QString guard = namespaceName.toUpper() + (namespaceName.endsWith("_") ? "H" : "_H");
+    
+    QString result;
+    result.append("// Generated by es_codegen from Project " + quote(projName) + "; do not edit.\n");
+    result.append("// Requires C++17; uses neither heap nor exceptions.\n\n");
+    result.append("#ifndef " + guard + "\n");
+    result.append("#define " + guard + "\n\n");
+    result.append("#include <cstdint>\n\n");
+    result.append("namespace " + namespaceName + "\n{\n\n");
+    
+    // Values
+    result.append("namespace value\n{\n\n");
+    for (int v = 0; v < varCount; v++)
+    {
+        result.append("enum class " + varIdentifiers.at(v) + " : std::uint16_t\n{\n");
+        for (int c = 0; c <= symbols.getDomainSize(v); c++)
+        {
+            result.append("    " + valueIdentifiers.at(v).at(c) + " = " + QString::number(c)
+                          + (c < symbols.getDomainSize(v) ? ",\n" : "\n"));
+        }
+        result.append("};\n\n");
+        
+        result.append("constexpr const char *const " + joinIdentifier(varIdentifiers.at(v), "names") + "[] = {");
+        for (int c = 0; c <= symbols.getDomainSize(v); c++)
+        {
+            result.append((c > 0 ? ", " : "") + quote(symbols.getValueName(v, static_cast<quint16>(c))));
+        }
+        result.append("};\n\n");
+    }
+    result.append("}\n\n");
+    
+    for (int v = 0; v < varCount; v++)
+    {
+        result.append("constexpr const char *toString(" + typeName(v) + " x) { return value::" + joinIdentifier(varIdentifiers.at(v), "names")
+                      + "[static_cast<std::uint16_t>(x)]; }\n");
+    }
+    result.append("\n");
+    
+    // Interface
+    result.append("struct Input\n{\n");
+    for (int varId : inputVarIds)
+    {
+        result.append("    " + typeName(varId) + " " + varIdentifiers.at(varId) + " = " + valueName(varId, 0) + ";\n");
+    }
+    result.append("};\n\n");
+    
+    result.append("struct Output\n{\n");
+    for (int varId : outputVarIds)
+    {
+        result.append("    " + typeName(varId) + " " + varIdentifiers.at(varId) + " = " + valueName(varId, 0) + ";\n");
+    }
+    result.append("};\n\n");
+    
+    // Rule tables, in the layout of "RuleProgram"
+    result.append("namespace rules\n{\n\n");
+    result.append("constexpr std::uint32_t varCount = " + QString::number(varCount) + ";\n");
+    result.append("constexpr std::uint32_t ruleCount = " + QString::number(program.getRuleCount()) + ";\n");
+    result.append("constexpr std::uint32_t levelCount = " + QString::number(program.getLevelCount()) + ";\n");
+    appendTable(&result, "std::uint32_t", "ifBegin", program.ifBegin);
+    appendTable(&result, "std::uint32_t", "ifVars", program.ifVars);
+    appendTable(&result, "std::uint16_t", "ifValues", program.ifValues);
+    appendTable(&result, "std::uint32_t", "thenBegin", program.thenBegin);
+    appendTable(&result, "std::uint32_t", "thenVars", program.thenVars);
+    appendTable(&result, "std::uint16_t", "thenValues", program.thenValues);
+    appendTable(&result, "std::uint32_t", "levelBegin", program.levelBegin);
+    // Number of the Rule in the Project, counting from "1"
+    std::vector<quint32> ruleNumbers;
+    for (quint32 ruleSource : program.ruleSource)
+    {
+        ruleNumbers.push_back(ruleSource + 1);
+    }
+    appendTable(&result, "std::uint32_t", "ruleNumbers", ruleNumbers);
+    result.append("\n}\n\n");
+    
+    // Evaluator
+    result.append("constexpr Output evaluate(const Input &in)\n{\n");
+    result.append("    std::uint16_t m[" + QString::number(qMax(varCount, 1)) + "] = {};\n");
+    for (int varId : inputVarIds)
+    {
+        result.append("    m[" + QString::number(varId) + "] = static_cast<std::uint16_t>(in." + varIdentifiers.at(varId) + ");\n");
+    }
+    
+    for (int l = 0; l < program.getLevelCount(); l++)
+    {
+        result.append("\n    // Level " + QString::number(l) + "\n");
+        for (quint32 r = program.levelBegin[l]; r < program.levelBegin[l + 1]; r++)
+        {
+            // Quoted, so that no name can end the comment line or continue it with a trailing backslash
+            result.append("    // Rule " + QString::number(program.ruleSource[r] + 1) + ") " + quote(interp.getCompiledRule(r).stringify()) + "\n");
+            
+            QStringList conditions;
+            for (quint32 i = program.ifBegin[r]; i < program.ifBegin[r + 1]; i++)
+            {
+                conditions.append("m[" + QString::number(program.ifVars[i]) + "] == " + QString::number(program.ifValues[i]));
+            }
+            
+            QString assignments;
+            for (quint32 j = program.thenBegin[r]; j < program.thenBegin[r + 1]; j++)
+            {
+                assignments.append(" m[" + QString::number(program.thenVars[j]) + "] = " + QString::number(program.thenValues[j]) + ";");
+            }
+            
+            if (conditions.isEmpty()) result.append("    {" + assignments + " }\n");
+            else result.append("    if (" + conditions.join(" && ") + ") {" + assignments + " }\n");
+        }
+    }
+    
+    result.append("\n    Output out;\n");
+    for (int varId : outputVarIds)
+    {
+        result.append("    out." + varIdentifiers.at(varId) + " = static_cast<" + typeName(varId) + ">(m[" + QString::number(varId) + "]);\n");
+    }
+    result.append("    return out;\n}\n\n");
+    
+    result.append("}\n\n");
+    result.append("#endif // " + guard + "\n");
+    
+    return result;
+}
+
+QString CodeGenerator::makeIdentifier(const QString &name, QSet<QString> *taken, const QString &companionSuffix)
+{
+    QString result;
+    for (int i = 0; i < name.length(); i++)
+    {
+        QChar ch = name.at(i);
+        bool valid = (ch.toLatin1() == '_') || (ch.toLatin1() >= 'a' && ch.toLatin1() <= 'z')
+                || (ch.toLatin1() >= 'A' && ch.toLatin1() <= 'Z') || (i > 0 && ch.toLatin1() >= '0' && ch.toLatin1() <= '9');
+        if (!valid) ch = QChar('_');
+        
+        // Names with "__" anywhere are reserved for the implementation, so runs of '_' become one
+        if (ch == QChar('_') && result.endsWith("_")) continue;
+        result.append(ch);
+    }
+    
+    // Names like "_Name" are reserved for the implementation too
+    if (result.isEmpty() || (result.at(0) == QChar('_') && result.length() > 1
+                             && result.at(1).toLatin1() >= 'A' && result.at(1).toLatin1() <= 'Z'))
+    {
+        result.prepend("v");
+    }
+    
+    auto isTaken = [&](const QString &identifier)
+    {
+        return taken->contains(identifier) || (!companionSuffix.isEmpty() && taken->contains(joinIdentifier(identifier, companionSuffix)));
+    };
+    
+    QString base = result;
+    for (int n = 1; isTaken(result); n++)
+    {
+        result = joinIdentifier(base, QString::number(n));
+    }
+    
+    taken->insert(result);
+    if (!companionSuffix.isEmpty()) taken->insert(joinIdentifier(result, companionSuffix));
+    return result;
+}
+
+QString CodeGenerator::joinIdentifier(const QString &identifier, const QString &suffix)
+{
+    return identifier + (identifier.endsWith("_") ? "" : "_") + suffix;
+}
+
+QString CodeGenerator::quote(const QString &text)
+{
+    QString result("\"");
+    for (int i = 0; i < text.length(); i++)
+    {
+        QChar ch = text.at(i);
+        ushort code = ch.unicode();
+        if (ch == QChar('"') || ch == QChar('\\')) result.append('\\');
+        
+        if (ch == QChar('\n')) result.append("\\n");
+        else if (ch == QChar('\r')) result.append("\\r");
+        else if (ch == QChar('\t')) result.append("\\t");
+        // Three octal digits, unlike "\x", never take the next character in
+        else if (code < 0x20 || code == 0x7f) result.append(QString("\\%1").arg(code, 3, 8, QChar('0')));
+        else result.append(ch);
+    }
+    result.append("\"");
+    return result;
+}
+
+QString CodeGenerator::typeName(int varId) const
+{
+    return "value::" + varIdentifiers.at(varId);
+}
+
+QString CodeGenerator::valueName(int varId, quint16 code) const
+{
+    return typeName(varId) + "::" + valueIdentifiers.at(varId).at(code);
+}
@@ -0,0 +1,48 @@
+#ifndef CODEGENERATOR_H
+#define CODEGENERATOR_H
+
+#include "interpreter.h"
+
+#include <QSet>
+
+
+// Generates a self-contained C++17 header evaluating the compiled program of the Interpreter.
+// Variables become enum classes of their Values (code "0" is "unset_"), Rules become straight-line code
+// over a stack array of Value codes in the evaluation order of the Interpreter, so results are the same.
+// The header needs neither Qt nor heap.
+class CodeGenerator
+{
+public:
+    // "Interpreter" must outlive the generator
+    CodeGenerator(const Interpreter &interp, const QString &projName);
+    
+public:
+    QString generateHeader() const;
+    
+    // Names in the header, for code using it
+    inline const QString &getNamespaceName() const { return namespaceName; }
+    inline const QString &getVarIdentifier(int varId) const { return varIdentifiers.at(varId); }
+    
+private:
+    // Valid C++ identifier for "name", not equal to any identifier in "taken"; the result is added to "taken".
+    // If "companionSuffix" is not empty, the result joined with it must be free too and is taken as well
+    static QString makeIdentifier(const QString &name, QSet<QString> *taken, const QString &companionSuffix = QString());
+    // "<identifier>_<suffix>" with a single '_' between them, so no "__" appears
+    static QString joinIdentifier(const QString &identifier, const QString &suffix);
+    static QString quote(const QString &text);
+    
+    QString typeName(int varId) const;
+    QString valueName(int varId, quint16 code) const;
+    
+private:
+    const Interpreter &interp;
+    QString projName;
+    QString namespaceName;
+    
+    // Per Variable id
+    QStringList varIdentifiers;
+    QList<QStringList> valueIdentifiers;
+    
+};
+
+#endif // CODEGENERATOR_H
@@ -0,0 +1,46 @@
+#-------------------------------------------------
+#
+# Generator of C++ evaluators for ES Projects
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = es_codegen
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ..
+
+
+SOURCES += \
+        main.cpp \
+    codegenerator.cpp \
+    ../project.cpp \
+    ../binaryprojectfile.cpp \
+    ../textprojectparser.cpp \
+    ../projectjournal.cpp \
+    ../workstealingpool.cpp \
+    ../interpreter.cpp \
+    ../symboltable.cpp \
+    ../ruleprogram.cpp \
+    ../rulegraph.cpp \
+    ../tracer.cpp
+
+HEADERS += \
+        codegenerator.h \
+    ../project.h \
+    ../binaryprojectfile.h \
+    ../textprojectparser.h \
+    ../projectjournal.h \
+    ../workstealingpool.h \
+    ../interpreter.h \
+    ../symboltable.h \
+    ../ruleprogram.h \
+    ../rulegraph.h \
+    ../tracer.h
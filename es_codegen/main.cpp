@@ -0,0 +1,72 @@
+#include "project.h"
+#include "interpreter.h"
+#include "codegenerator.h"
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <cstdio>
+
+// Usage: es_codegen <project.esp|project.esb> [output.h]
+// Without output path the header is written next to the Project as "<project name>.h"
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    
+    QStringList args = a.arguments();
+    if (args.length() < 2 || args.length() > 3)
+    {
+        fprintf(stderr, "Usage: es_codegen <project.esp|project.esb> [output.h]\n");
+        return 2;
+    }
+    
+    QString projFilePath = args.at(1);
+    if (!QFileInfo(projFilePath).isFile())
+    {
+        fprintf(stderr, "Can not open Project \"%s\"\n", qPrintable(projFilePath));
+        return 1;
+    }
+    
+    Project proj(projFilePath);
+    if (proj.getLoadError())
+    {
+        fprintf(stderr, "%s\n", qPrintable(proj.getLoadError().text()));
+        if (proj.getLoadError().getCode() != ErrorCode::ParseError) return 1;
+    }
+    
+    Interpreter interp(proj.getVarNames(), proj.getAllVarValues(), proj.getRules());
+    
+    if (!interp.getUnreachableRuleList().isEmpty())
+    {
+        QStringList unreachableRules;
+        for (int rule : interp.getUnreachableRuleList())
+        {
+            unreachableRules.append(QString::number(rule + 1));
+        }
+        fprintf(stderr, "Warning: these Rules will never be evaluated: %s\n", qPrintable(unreachableRules.join(", ")));
+    }
+    
+    QString outFilePath = (args.length() == 3) ? args.at(2)
+                                               : projFilePath.mid(0, projFilePath.lastIndexOf("/", -1) + 1) + proj.getProjName() + ".h";
+    
+    QSaveFile outFile(outFilePath);
+    if (!outFile.open(QSaveFile::WriteOnly | QSaveFile::Truncate))
+    {
+        fprintf(stderr, "Can not write \"%s\"\n", qPrintable(outFilePath));
+        return 1;
+    }
+    
+    QTextStream outFileStream(&outFile);
+    outFileStream << CodeGenerator(interp, proj.getProjName()).generateHeader();
+    outFileStream.flush();
+    
+    if (!outFile.commit())
+    {
+        fprintf(stderr, "Can not write \"%s\"\n", qPrintable(outFilePath));
+        return 1;
+    }
+    
+    return 0;
+}
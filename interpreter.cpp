@@ -1,14 +1,127 @@
 #include "interpreter.h"
+#include "rulegraph.h"
+#include "tracer.h"
 
-#include <QDebug>
+#include <QHash>
+#include <QSet>
 
-Interpreter::Interpreter(const QStringList &varNames, const QList<Rule> &rules) :
+#include <algorithm>
+
+namespace
+{
+
+// FNV-1a, one step per character or table entry
+struct Fingerprint
+{
+    quint64 value = Q_UINT64_C(14695981039346656037);
+    
+    void mix(quint64 x)
+    {
+        value ^= x;
+        value *= Q_UINT64_C(1099511628211);
+    }
+    
+    void mixString(const QString &string)
+    {
+        for (const QChar &ch : string)
+        {
+            mix(ch.unicode());
+        }
+        mix(0x10000);
+    }
+    
+    template <typename T>
+    void mixTable(const std::vector<T> &table)
+    {
+        mix(table.size());
+        for (T x : table)
+        {
+            mix(static_cast<quint64>(x));
+        }
+    }
+};
+
+}
+
+Interpreter::Interpreter(const QStringList &varNames, const QList<QStringList> &varValues, const QList<Rule> &rules) :
     varNames(varNames),
+    varValues(varValues),
     rules(rules)
 {
     initialize();
 }
 
+Interpreter::Interpreter(const Interpreter &base, const QMap<QString, QString> &pinnedInputs) :
+    varNames(base.varNames),
+    varValues(base.varValues),
+    rules(base.rules),
+    symbols(base.symbols),
+    outputVars(base.outputVars),
+    unreachableRules(base.unreachableRules)
+{
+    // Value code of every pinned Variable, "-1" for the rest
+    std::vector<qint32> pinned(symbols.getVarCount(), -1);
+    for (int varId : base.inputVarIds)
+    {
+        auto it = pinnedInputs.constFind(symbols.getVarName(varId));
+        if (it != pinnedInputs.constEnd()) pinned[varId] = symbols.getValueCode(varId, it.value());
+        else inputVars.append(symbols.getVarName(varId));
+    }
+    
+    // Input Variables are never assigned, so folding does not depend on the Rule order;
+    // the order itself is kept, because the last fired Rule wins
+    const RuleProgram &baseProgram = base.program;
+    RuleProgram source;
+    std::vector<int> levels;
+    std::vector<quint32> origin;
+    int levelCount = 0;
+    
+    for (int l = 0; l < baseProgram.getLevelCount(); l++)
+    {
+        bool levelUsed = false;
+        
+        for (quint32 r = baseProgram.levelBegin[l]; r < baseProgram.levelBegin[l + 1]; r++)
+        {
+            bool dead = false;
+            for (quint32 i = baseProgram.ifBegin[r]; i < baseProgram.ifBegin[r + 1]; i++)
+            {
+                qint32 code = pinned[baseProgram.ifVars[i]];
+                if (code != -1 && code != baseProgram.ifValues[i]) dead = true;
+            }
+            if (dead) continue;
+            
+            for (quint32 i = baseProgram.ifBegin[r]; i < baseProgram.ifBegin[r + 1]; i++)
+            {
+                if (pinned[baseProgram.ifVars[i]] != -1) continue;
+                source.ifVars.push_back(baseProgram.ifVars[i]);
+                source.ifValues.push_back(baseProgram.ifValues[i]);
+            }
+            
+            for (quint32 j = baseProgram.thenBegin[r]; j < baseProgram.thenBegin[r + 1]; j++)
+            {
+                source.thenVars.push_back(baseProgram.thenVars[j]);
+                source.thenValues.push_back(baseProgram.thenValues[j]);
+            }
+            
+            source.endRule();
+            levels.push_back(levelCount);
+            origin.push_back(baseProgram.ruleSource[r]);
+            levelUsed = true;
+        }
+        
+        if (levelUsed) levelCount++;
+    }
+    
+    compile(source, levels, levelCount);
+    
+    for (quint32 &ruleSource : program.ruleSource)
+    {
+        ruleSource = origin[ruleSource];
+    }
+    
+    computeFingerprint();
+}
+
 const QStringList &Interpreter::getRequiredInputVarList() const
 {
     return inputVars;
@@ -21,132 +134,329 @@ const QStringList &Interpreter::getOutputVarList() const
 
 QMap<QString, QString> Interpreter::interpret(const QMap<QString, QString> &input) const
 {
+    // Strings are converted to codes only here and back at the end
+    std::vector<quint16> memory(symbols.getVarCount(), 0);
+    
+    for (auto it = input.constBegin(); it != input.constEnd(); ++it)
+    {
+        int varId = symbols.getVarId(it.key());
+        if (varId == -1) continue;
+        
+        // Values outside of the domain can not satisfy any IF-Pair
+        memory[varId] = symbols.getValueCode(varId, it.value());
+    }
+    
+    run(memory);
+    
+    // Making output map
     QMap<QString, QString> output;
-    QMap<QString, QString> internal;
-    internal = input;
+    for (int varId : outputVarIds)
+    {
+        output[symbols.getVarName(varId)] = symbols.getValueName(varId, memory[varId]);
+    }
     
-    qDebug() << "\n " << "Input vars:";
-    foreach (auto key, input.keys())
+    return output;
+}
+
+QStringList Interpreter::interpretAndStringify(const QMap<QString, QString> &input) const
+{
+    auto output = interpret(input);
+    
+    QStringList result;
+    
+    foreach (auto key, output.keys())
     {
-        qDebug() << Pair(key, input[key]).stringify(true);
+        result.append(key + " <= " + output.value(key));
     }
     
-    qDebug() << "\n " << "Internal vars:";
-    foreach (auto key, internal.keys())
+    return result;
+}
+
+QMap<QString, QString> Interpreter::interpretGoals(const QStringList &goals, const std::function<QString(const QString &)> &fetchInput) const
+{
+    // Dependency cone: writers of the goals, then writers of everything they read
+    QSet<int> coneVars;
+    QSet<quint32> coneRules;
+    std::vector<int> pendingVars;
+    
+    for (const QString &goal : goals)
     {
-        qDebug() << Pair(key, internal[key]).stringify(true);
+        int varId = symbols.getVarId(goal);
+        if (varId == -1 || coneVars.contains(varId)) continue;
+        coneVars.insert(varId);
+        pendingVars.push_back(varId);
     }
     
-    for (auto level : structuredRules)
+    while (!pendingVars.empty())
     {
+        int varId = pendingVars.back();
+        pendingVars.pop_back();
         
-        qDebug() << "\n " << "Level processing started";
-        
-        for (auto rule : level)
+        for (quint32 w = program.writerBegin[varId]; w < program.writerBegin[varId + 1]; w++)
         {
+            quint32 r = program.writerRules[w];
+            if (coneRules.contains(r)) continue;
+            coneRules.insert(r);
             
-            qDebug() << "\n " << "Rule : " << rule.stringify();
-            
-            bool result = true;
-            
-            for (auto ifPair : rule.ifBlock)
+            for (quint32 i = program.ifBegin[r]; i < program.ifBegin[r + 1]; i++)
             {
-                
-                qDebug() << "IF-Pair : " << ifPair.stringify(true);
-                
-                if (internal.value(ifPair.var) != ifPair.value)
-                {
-                    
-                    qDebug() << "Pair gives False";
-                    
-                    result = false;
-                    break;
-                }
+                int ifVarId = static_cast<int>(program.ifVars[i]);
+                if (coneVars.contains(ifVarId)) continue;
+                coneVars.insert(ifVarId);
+                pendingVars.push_back(ifVarId);
             }
-            
-            if (result)
+        }
+    }
+    
+    std::vector<quint32> order(coneRules.begin(), coneRules.end());
+    std::sort(order.begin(), order.end());
+    
+    // Only Variables of the cone are ever touched; absent means unset
+    QHash<int, quint16> memory;
+    QSet<int> fetched;
+    std::vector<bool> isInput(symbols.getVarCount(), false);
+    for (int varId : inputVarIds)
+    {
+        isInput[varId] = true;
+    }
+    
+    for (quint32 r : order)
+    {
+        // IF-Pairs on known Values first, so a failing one saves fetching
+        bool holds = true;
+        for (quint32 i = program.ifBegin[r]; i < program.ifBegin[r + 1] && holds; i++)
+        {
+            int varId = static_cast<int>(program.ifVars[i]);
+            if (isInput[varId] && !fetched.contains(varId)) continue;
+            holds = (memory.value(varId, 0) == program.ifValues[i]);
+        }
+        
+        for (quint32 i = program.ifBegin[r]; i < program.ifBegin[r + 1] && holds; i++)
+        {
+            int varId = static_cast<int>(program.ifVars[i]);
+            if (isInput[varId] && !fetched.contains(varId))
             {
-                for (auto thenPair : rule.thenBlock)
-                {
-                    
-                    qDebug() << "Assign : " << Pair(thenPair.var, thenPair.value).stringify(false);
-                    
-                    internal[thenPair.var] = thenPair.value;
-                }
+                fetched.insert(varId);
+                memory.insert(varId, symbols.getValueCode(varId, fetchInput(symbols.getVarName(varId))));
             }
+            holds = (memory.value(varId, 0) == program.ifValues[i]);
+        }
+        
+        if (!holds) continue;
+        
+        for (quint32 j = program.thenBegin[r]; j < program.thenBegin[r + 1]; j++)
+        {
+            memory.insert(static_cast<int>(program.thenVars[j]), program.thenValues[j]);
         }
     }
     
-    qDebug() << "\n " << "Output vars:";
-    // Making output map
-    for (auto var : outputVars)
+    QMap<QString, QString> output;
+    for (const QString &goal : goals)
     {
-        output[var] = internal[var];
-        
-        qDebug() << Pair(var, output[var]).stringify(false);
+        int varId = symbols.getVarId(goal);
+        if (varId == -1) continue;
         
+        if (isInput[varId] && !fetched.contains(varId))
+        {
+            fetched.insert(varId);
+            memory.insert(varId, symbols.getValueCode(varId, fetchInput(goal)));
+        }
+        output[goal] = symbols.getValueName(varId, memory.value(varId, 0));
     }
     
     return output;
 }
 
-QStringList Interpreter::interpretAndStringify(const QMap<QString, QString> &input) const
+Interpreter Interpreter::specialize(const QMap<QString, QString> &pinnedInputs) const
 {
-    auto output = interpret(input);
+    return Interpreter(*this, pinnedInputs);
+}
+
+void Interpreter::interpretBatch(const BatchInput &input, BatchOutput &output, int firstRow, int rowCount) const
+{
+    if (rowCount == -1) rowCount = input.rowCount - firstRow;
     
-    QStringList result;
+    // One working memory is reused for all rows
+    std::vector<quint16> memory(symbols.getVarCount(), 0);
     
-    foreach (auto key, output.keys())
+    int inputCount = static_cast<int>(inputVarIds.size());
+    int outputCount = static_cast<int>(outputVarIds.size());
+    
+    for (int row = firstRow; row < firstRow + rowCount; row++)
     {
-        result.append(key + " <= " + output.value(key));
+        for (int varId : assignedVarIds)
+        {
+            memory[varId] = 0;
+        }
+        
+        for (int k = 0; k < inputCount; k++)
+        {
+            memory[inputVarIds[k]] = input.columns[k][row];
+        }
+        
+        run(memory);
+        
+        for (int k = 0; k < outputCount; k++)
+        {
+            output.columns[k][row] = memory[outputVarIds[k]];
+        }
+    }
+}
+
+const SymbolTable &Interpreter::getSymbols() const
+{
+    return symbols;
+}
+
+const RuleProgram &Interpreter::getProgram() const
+{
+    return program;
+}
+
+Rule Interpreter::getCompiledRule(int rule) const
+{
+    Rule result;
+    
+    for (quint32 i = program.ifBegin[rule]; i < program.ifBegin[rule + 1]; i++)
+    {
+        result.ifBlock.append(Pair(symbols.getVarName(program.ifVars[i]), symbols.getValueName(program.ifVars[i], program.ifValues[i])));
+    }
+    
+    for (quint32 j = program.thenBegin[rule]; j < program.thenBegin[rule + 1]; j++)
+    {
+        result.thenBlock.append(Pair(symbols.getVarName(program.thenVars[j]), symbols.getValueName(program.thenVars[j], program.thenValues[j])));
     }
     
     return result;
 }
 
-void Interpreter::initialize()
+const QList<int> &Interpreter::getUnreachableRuleList() const
 {
-    QStringList ifBlockVars;
-    QStringList thenBlockVars;
-    //QStringList inputVars;
-    QStringList internalVars;
-    //QStringList outputVars;
+    return unreachableRules;
+}
+
+const std::vector<int> &Interpreter::getInputVarIds() const
+{
+    return inputVarIds;
+}
+
+const std::vector<int> &Interpreter::getOutputVarIds() const
+{
+    return outputVarIds;
+}
+
+quint64 Interpreter::getFingerprint() const
+{
+    return fingerprint;
+}
+
+void Interpreter::run(std::vector<quint16> &memory) const
+{
+    quint16 *mem = memory.data();
+    
+    const quint32 *ifVars = program.ifVars.data();
+    const quint16 *ifValues = program.ifValues.data();
+    const quint32 *thenVars = program.thenVars.data();
+    const quint16 *thenValues = program.thenValues.data();
+    const quint32 *ifBegin = program.ifBegin.data();
+    const quint32 *thenBegin = program.thenBegin.data();
     
-    structuredRules.append(QList<Rule>());
+    ES_TRACE_EVENT(0, 0, 0, TraceEventKind::InterpretationStarted, 0);
     
-    for (auto rule : rules)
+    auto evaluate = [&](quint32 r, int level)
     {
-        // Initialization of "structuredRules"
-        structuredRules[0].append(rule);
+        quint32 i = ifBegin[r];
+        quint32 ifEnd = ifBegin[r + 1];
+        while (i < ifEnd && mem[ifVars[i]] == ifValues[i]) i++;
+        
+        ES_TRACE_EVENT(r, static_cast<quint16>(i - ifBegin[r]), static_cast<quint16>(level),
+                       TraceEventKind::RuleEvaluated, static_cast<quint8>(i == ifEnd));
+        Q_UNUSED(level);
+        
+        if (i == ifEnd)
+        {
+            for (quint32 j = thenBegin[r]; j < thenBegin[r + 1]; j++)
+            {
+                mem[thenVars[j]] = thenValues[j];
+            }
+        }
+    };
+    
+    int levelCount = program.getLevelCount();
+    for (int l = 0; l < levelCount; l++)
+    {
+        qint32 dispatchVar = program.dispatchVars[l];
+        if (dispatchVar == -1)
+        {
+            for (quint32 r = program.levelBegin[l]; r < program.levelBegin[l + 1]; r++)
+            {
+                evaluate(r, l);
+            }
+            continue;
+        }
+        
+        // Only Rules expecting the current Value of the dispatch Variable and the residual Rules can fire;
+        // both lists are merged to keep evaluation order.
+        // Codes out of the domain can match nothing, so any bucket will do for them.
+        quint32 code = mem[dispatchVar];
+        if (code > static_cast<quint32>(symbols.getDomainSize(dispatchVar))) code = 0;
+        quint32 base = program.dispatchBase[l];
         
-        // Find all If Block Vars
-        for (auto ifPair : rule.ifBlock)
+        const quint32 *a = program.dispatchRules.data() + program.dispatchBegin[base + code];
+        const quint32 *aEnd = program.dispatchRules.data() + program.dispatchBegin[base + code + 1];
+        const quint32 *b = program.residualRules.data() + program.residualBegin[l];
+        const quint32 *bEnd = program.residualRules.data() + program.residualBegin[l + 1];
+        
+        while (a != aEnd && b != bEnd)
         {
-            if (!ifBlockVars.contains(ifPair.var)) ifBlockVars.append(ifPair.var);
+            evaluate((*a < *b) ? *a++ : *b++, l);
+        }
+        while (a != aEnd) evaluate(*a++, l);
+        while (b != bEnd) evaluate(*b++, l);
+    }
+}
+
+void Interpreter::initialize()
+{
+    symbols = SymbolTable(varNames, varValues);
+    
+    // Rules in source order; they may refer to Variables and Values that are not declared in the Project
+    RuleProgram source;
+    for (const Rule &rule : rules)
+    {
+        for (const Pair &ifPair : rule.ifBlock)
+        {
+            int varId = symbols.internVar(ifPair.var);
+            source.ifVars.push_back(static_cast<quint32>(varId));
+            source.ifValues.push_back(symbols.internValue(varId, ifPair.value));
         }
         
-        // Find all Then Block Vars
-        for (auto thenPair : rule.thenBlock)
+        for (const Pair &thenPair : rule.thenBlock)
         {
-            if (!thenBlockVars.contains(thenPair.var)) thenBlockVars.append(thenPair.var);
+            int varId = symbols.internVar(thenPair.var);
+            source.thenVars.push_back(static_cast<quint32>(varId));
+            source.thenValues.push_back(symbols.internValue(varId, thenPair.value));
         }
+        
+        source.endRule();
     }
+    source.endLevel();
+    source.buildVarIndex(symbols.getVarCount());
     
     // Vars distribution on Input, Internal and Output
-    for (auto var : varNames)
+    std::vector<quint8> isInput(symbols.getVarCount(), 0);
+    for (const QString &var : varNames)
     {
-        bool isInIfBlock = ifBlockVars.contains(var);
-        bool isInThenBlock = thenBlockVars.contains(var);
+        int varId = symbols.getVarId(var);
+        bool isInIfBlock = (source.readerBegin[varId + 1] > source.readerBegin[varId]);
+        bool isInThenBlock = (source.writerBegin[varId + 1] > source.writerBegin[varId]);
         
         if (isInIfBlock)
         {
-            if (isInThenBlock)
-            {
-                internalVars.append(var);
-            }
-            else
+            if (!isInThenBlock)
             {
                 inputVars.append(var);
+                isInput[varId] = 1;
             }
         }
         else if (isInThenBlock)
@@ -155,103 +465,112 @@ void Interpreter::initialize()
         }
     }
     
+    // Rule distribution by levels
+    RuleGraph graph(source, isInput);
+    for (int rule : graph.getUnreachableRules())
+    {
+        unreachableRules.append(rule);
+    }
     
-    QStringList definedVars;
+    compile(source, graph.getLevels(), graph.getLevelCount());
+    computeFingerprint();
+}
+
+void Interpreter::compile(const RuleProgram &source, const std::vector<int> &levels, int levelCount)
+{
+    // Stable bucket sort of Rules by Level keeps source order inside every Level
+    std::vector<int> levelSize(levelCount + 1, 0);
+    for (int level : levels)
+    {
+        if (level != -1) levelSize[level + 1]++;
+    }
+    for (int l = 0; l < levelCount; l++)
+    {
+        levelSize[l + 1] += levelSize[l];
+    }
     
-    definedVars.append(inputVars);
+    std::vector<int> order(levelSize[levelCount]);
+    for (int r = 0; r < static_cast<int>(levels.size()); r++)
+    {
+        if (levels[r] != -1) order[levelSize[levels[r]]++] = r;
+    }
     
-    // Rule distribution by levels
-    for (int i = 0; i < structuredRules.length(); i++)
+    int next = 0;
+    for (int l = 0; l < levelCount; l++)
     {
-        //QList<Rule> &level = structuredRules[i];
-        bool nextLevelExists = false;
-        
-        qDebug() << "\n " << "Level " << i << " processing started";
-        
-        for (int j = 0; j < structuredRules[i].length(); j++)
+        // "levelSize[l]" now points to the end of Level "l"
+        for (; next < levelSize[l]; next++)
         {
-            //Rule &rule = structuredRules[i][j];
-            bool ruleLifted = false;
+            int r = order[next];
             
-            qDebug() << "\n " << "Rule " << j << " : " << structuredRules[i][j].stringify();
-            
-            for (int k = 0; k < structuredRules[i][j].ifBlock.length(); k++)
+            for (quint32 i = source.ifBegin[r]; i < source.ifBegin[r + 1]; i++)
             {
-                //Pair &ifPair = structuredRules[i][j].ifBlock[k];
-                
-                qDebug() << "IF-Pair " << k << " : " << structuredRules[i][j].ifBlock[k].stringify(true);
-                
-                if (!definedVars.contains(structuredRules[i][j].ifBlock[k].var))
-                {
-                    
-                    qDebug() << "Defined-Vars not contains " << structuredRules[i][j].ifBlock[k].var;
-                    
-                    if (!nextLevelExists)
-                    {
-                        
-                        qDebug() << "Next-Level not exists";
-                        
-                        structuredRules.append(QList<Rule>());
-                        nextLevelExists = true;
-                    }
-                    
-                    structuredRules[i + 1].append(structuredRules[i].takeAt(j));
-                    j--;
-                    ruleLifted = true;
-                    break;
-                }
+                program.ifVars.push_back(source.ifVars[i]);
+                program.ifValues.push_back(source.ifValues[i]);
             }
             
-            if (ruleLifted)
+            for (quint32 j = source.thenBegin[r]; j < source.thenBegin[r + 1]; j++)
             {
-                
-                qDebug() << "Rule Lifted. Level length: " << structuredRules[i].length();
-                
-                continue;
+                program.thenVars.push_back(source.thenVars[j]);
+                program.thenValues.push_back(source.thenValues[j]);
             }
+            
+            program.ruleSource.push_back(static_cast<quint32>(r));
+            program.endRule();
         }
         
-        qDebug() << "\n ";
-        
-        // Add to "definedVars" all Vars from current level
-        for (auto rule : structuredRules[i])
-        {
-            for (auto thenPair : rule.thenBlock)
-            {
-                if (!definedVars.contains(thenPair.var))
-                {
-                    
-                    qDebug() << "Var " << thenPair.var << " added";
-                    
-                    definedVars.append(thenPair.var);
-                }
-            }
-        }
+        program.endLevel();
     }
     
-    for (int i = 0; i < structuredRules.length(); i++)
+    program.buildVarIndex(symbols.getVarCount());
+    
+    std::vector<int> domainSizes(symbols.getVarCount());
+    for (int v = 0; v < symbols.getVarCount(); v++)
     {
-        QList<Rule> &level = structuredRules[i];
-        qDebug() << "\n " << "Level: " << i;
-        
-        for (int j = 0; j < level.length(); j++)
-        {
-            Rule &rule = level[j];
-            qDebug() << "Rule: " << rule.stringify();
-            
-        }
+        domainSizes[v] = symbols.getDomainSize(v);
+    }
+    program.buildDispatchIndex(domainSizes);
+    
+    for (const QString &var : inputVars)
+    {
+        inputVarIds.push_back(symbols.getVarId(var));
     }
     
-    qDebug() << "\n " << "Input vars:";
-    for (int i = 0; i < inputVars.length(); i++)
+    for (const QString &var : outputVars)
     {
-        qDebug() << inputVars[i];
+        outputVarIds.push_back(symbols.getVarId(var));
     }
     
-    qDebug() << "\n " << "Output vars:";
-    for (int i = 0; i < outputVars.length(); i++)
+    std::vector<bool> assigned(symbols.getVarCount(), false);
+    for (quint32 varId : program.thenVars)
     {
-        qDebug() << outputVars[i];
+        if (assigned[varId]) continue;
+        assigned[varId] = true;
+        assignedVarIds.push_back(static_cast<int>(varId));
     }
+}
+
+void Interpreter::computeFingerprint()
+{
+    Fingerprint hash;
+    
+    for (int v = 0; v < symbols.getVarCount(); v++)
+    {
+        hash.mixString(symbols.getVarName(v));
+        for (int c = 1; c <= symbols.getDomainSize(v); c++)
+        {
+            hash.mixString(symbols.getValueName(v, static_cast<quint16>(c)));
+        }
+    }
+    
+    hash.mixTable(program.ifVars);
+    hash.mixTable(program.ifValues);
+    hash.mixTable(program.thenVars);
+    hash.mixTable(program.thenValues);
+    hash.mixTable(program.ifBegin);
+    hash.mixTable(program.thenBegin);
+    hash.mixTable(inputVarIds);
+    hash.mixTable(outputVarIds);
     
+    fingerprint = hash.value;
 }
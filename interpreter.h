@@ -2,36 +2,88 @@
 #define INTERPRETER_H
 
 #include "project.h"
+#include "symboltable.h"
+#include "ruleprogram.h"
 
+#include <functional>
+#include <vector>
 
 class Interpreter
 {
 public:
-    Interpreter(const QStringList &varNames, const QList<Rule> &rules);
+    // Columnar block of Value codes (see "SymbolTable"), one column per Variable;
+    // "columns[k][row]" is the Value of k-th Variable in the row
+    struct BatchInput
+    {
+        int rowCount;
+        // In the order of "getRequiredInputVarList()"
+        std::vector<const quint16 *> columns;
+    };
+    
+    struct BatchOutput
+    {
+        // In the order of "getOutputVarList()"; every column must have place for all rows
+        std::vector<quint16 *> columns;
+    };
+    
+public:
+    Interpreter(const QStringList &varNames, const QList<QStringList> &varValues, const QList<Rule> &rules);
     
 public:
     const QStringList &getRequiredInputVarList() const;
     const QStringList &getOutputVarList() const;
+    // Indices of Rules that can never be evaluated, because some of their IF-Variables
+    // are neither entered nor assigned by an evaluable Rule
+    const QList<int> &getUnreachableRuleList() const;
     QMap<QString, QString> interpret(const QMap<QString, QString> &input) const;
     QStringList interpretAndStringify(const QMap<QString, QString> &input) const;
+    // Backward chaining: evaluates only Rules that can change the "goals" Variables, in the usual order.
+    // Input Values are asked from "fetchInput" only when an IF-Pair needs them and its other IF-Pairs on
+    // known Values hold; every Input is asked at most once, empty string means unset.
+    QMap<QString, QString> interpretGoals(const QStringList &goals, const std::function<QString(const QString &)> &fetchInput) const;
+    // Residual Interpreter for the case when some Input Variables always have the given Values:
+    // IF-Pairs on them are folded, Rules that can not fire any more are dropped and empty Levels removed.
+    // Pinned Variables are no longer required Inputs; Variables and Values keep their ids.
+    Interpreter specialize(const QMap<QString, QString> &pinnedInputs) const;
+    // Interprets rows [firstRow, firstRow + rowCount); "-1" means all rows up to the end
+    void interpretBatch(const BatchInput &input, BatchOutput &output, int firstRow = 0, int rowCount = -1) const;
+    
+    const SymbolTable &getSymbols() const;
+    const RuleProgram &getProgram() const;
+    // Rule of the program converted back to Names and Values
+    Rule getCompiledRule(int rule) const;
+    const std::vector<int> &getInputVarIds() const;
+    const std::vector<int> &getOutputVarIds() const;
+    // Hash of Variables, Values and the compiled program; equal for Interpreters giving equal results
+    quint64 getFingerprint() const;
     
 private:
+    Interpreter(const Interpreter &base, const QMap<QString, QString> &pinnedInputs);
+    
     void initialize();
+    // Stores Rules of "source" into "program" ordered by their Levels; "-1" Level drops the Rule
+    void compile(const RuleProgram &source, const std::vector<int> &levels, int levelCount);
+    void computeFingerprint();
+    
+    // Working memory holds one Value code per Variable id
+    void run(std::vector<quint16> &memory) const;
     
 private:
     QStringList varNames;
-    //QList<QStringList> varValues;
+    QList<QStringList> varValues;
     QList<Rule> rules;
     
-    QList<QList<Rule>> structuredRules;
+    SymbolTable symbols;
+    RuleProgram program;
+    std::vector<int> inputVarIds;
+    std::vector<int> outputVarIds;
+    // Variables that some Rule assigns; only they have to be cleared between batch rows
+    std::vector<int> assignedVarIds;
+    quint64 fingerprint;
     
-//    QStringList ifBlockVars;
-//    QStringList thenBlockVars;
     QStringList inputVars;
-//    QStringList internalVars;
     QStringList outputVars;
-    
-    //mutable QMap<QString, QString> enteredValues;
+    QList<int> unreachableRules;
     
 };
 
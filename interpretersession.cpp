@@ -0,0 +1,192 @@
+#include "interpretersession.h"
+
+#include <algorithm>
+
+
+InterpreterSession::InterpreterSession(const Interpreter &interp) :
+    interp(interp),
+    program(interp.getProgram()),
+    inputs(interp.getSymbols().getVarCount(), 0),
+    pairHolds(program.ifVars.size(), 0),
+    pairStale(program.ifVars.size(), 0),
+    holdingPairs(program.getRuleCount(), 0),
+    fired(program.getRuleCount(), 0),
+    queued(program.getRuleCount(), 0),
+    evaluatedRuleCount(0)
+{
+    reset(QMap<QString, QString>());
+}
+
+void InterpreterSession::reset(const QMap<QString, QString> &input)
+{
+    const SymbolTable &symbols = interp.getSymbols();
+    
+    std::fill(inputs.begin(), inputs.end(), 0);
+    for (auto it = input.constBegin(); it != input.constEnd(); ++it)
+    {
+        int varId = symbols.getVarId(it.key());
+        if (varId == -1) continue;
+        inputs[varId] = symbols.getValueCode(varId, it.value());
+    }
+    
+    // Plain forward pass; "memory" always holds the values the next Rule sees
+    std::vector<quint16> memory(inputs);
+    int ruleCount = program.getRuleCount();
+    for (int r = 0; r < ruleCount; r++)
+    {
+        quint32 holding = 0;
+        for (quint32 i = program.ifBegin[r]; i < program.ifBegin[r + 1]; i++)
+        {
+            pairHolds[i] = (memory[program.ifVars[i]] == program.ifValues[i]);
+            pairStale[i] = 0;
+            holding += pairHolds[i];
+        }
+        holdingPairs[r] = holding;
+        fired[r] = (holding == program.ifBegin[r + 1] - program.ifBegin[r]);
+        
+        if (fired[r])
+        {
+            for (quint32 j = program.thenBegin[r]; j < program.thenBegin[r + 1]; j++)
+            {
+                memory[program.thenVars[j]] = program.thenValues[j];
+            }
+        }
+    }
+    
+    evaluatedRuleCount = ruleCount;
+}
+
+void InterpreterSession::setInput(const QString &varName, const QString &value)
+{
+    const SymbolTable &symbols = interp.getSymbols();
+    
+    int varId = symbols.getVarId(varName);
+    if (varId == -1) return;
+    
+    setInput(varId, symbols.getValueCode(varId, value));
+}
+
+void InterpreterSession::setInput(int varId, quint16 valueCode)
+{
+    evaluatedRuleCount = 0;
+    if (inputs[varId] == valueCode) return;
+    inputs[varId] = valueCode;
+    
+    // Input is seen only up to the first fired Rule that assigns the Variable
+    scheduleReaders(varId, -1, nextFiredWriter(varId, -1));
+    propagate();
+}
+
+quint16 InterpreterSession::getValue(int varId) const
+{
+    return valueBefore(varId, program.getRuleCount());
+}
+
+QMap<QString, QString> InterpreterSession::getOutput() const
+{
+    const SymbolTable &symbols = interp.getSymbols();
+    
+    QMap<QString, QString> output;
+    for (int varId : interp.getOutputVarIds())
+    {
+        output[symbols.getVarName(varId)] = symbols.getValueName(varId, getValue(varId));
+    }
+    
+    return output;
+}
+
+int InterpreterSession::getEvaluatedRuleCount() const
+{
+    return evaluatedRuleCount;
+}
+
+quint16 InterpreterSession::valueBefore(int varId, int rule) const
+{
+    auto first = program.writerRules.begin() + program.writerBegin[varId];
+    auto last = program.writerRules.begin() + program.writerBegin[varId + 1];
+    
+    // Walk back from the last writer before the Rule; later Pairs of one Rule win
+    auto it = std::lower_bound(first, last, static_cast<quint32>(rule));
+    while (it != first)
+    {
+        --it;
+        if (fired[*it]) return program.writerValues[it - program.writerRules.begin()];
+    }
+    
+    return inputs[varId];
+}
+
+void InterpreterSession::evaluateRule(int rule)
+{
+    // Other IF-Pairs still see the Values they saw last time
+    for (quint32 i = program.ifBegin[rule]; i < program.ifBegin[rule + 1]; i++)
+    {
+        if (!pairStale[i]) continue;
+        pairStale[i] = 0;
+        
+        quint8 holds = (valueBefore(program.ifVars[i], rule) == program.ifValues[i]);
+        holdingPairs[rule] += holds;
+        holdingPairs[rule] -= pairHolds[i];
+        pairHolds[i] = holds;
+    }
+    
+    quint8 nowFired = (holdingPairs[rule] == program.ifBegin[rule + 1] - program.ifBegin[rule]);
+    if (nowFired == fired[rule]) return;
+    fired[rule] = nowFired;
+    
+    // Assignments of the Rule appeared or disappeared: readers up to the next fired writer see it
+    for (quint32 j = program.thenBegin[rule]; j < program.thenBegin[rule + 1]; j++)
+    {
+        int varId = program.thenVars[j];
+        scheduleReaders(varId, rule, nextFiredWriter(varId, rule));
+    }
+}
+
+void InterpreterSession::scheduleReaders(int varId, int afterRule, int lastRule)
+{
+    auto first = program.readers.begin() + program.readerBegin[varId];
+    auto last = program.readers.begin() + program.readerBegin[varId + 1];
+    
+    auto from = (afterRule < 0) ? first : std::upper_bound(first, last, static_cast<quint32>(afterRule));
+    auto to = std::upper_bound(from, last, static_cast<quint32>(lastRule));
+    
+    for (auto it = from; it != to; ++it)
+    {
+        for (quint32 i = program.ifBegin[*it]; i < program.ifBegin[*it + 1]; i++)
+        {
+            if (static_cast<int>(program.ifVars[i]) == varId) pairStale[i] = 1;
+        }
+        
+        if (queued[*it]) continue;
+        queued[*it] = 1;
+        queue.push(static_cast<int>(*it));
+    }
+}
+
+int InterpreterSession::nextFiredWriter(int varId, int afterRule) const
+{
+    auto first = program.writerRules.begin() + program.writerBegin[varId];
+    auto last = program.writerRules.begin() + program.writerBegin[varId + 1];
+    
+    auto it = (afterRule < 0) ? first : std::upper_bound(first, last, static_cast<quint32>(afterRule));
+    for (; it != last; ++it)
+    {
+        if (fired[*it]) return static_cast<int>(*it);
+    }
+    
+    return program.getRuleCount();
+}
+
+void InterpreterSession::propagate()
+{
+    // Rules only schedule Rules after themselves, so popping in order visits each at most once
+    while (!queue.empty())
+    {
+        int rule = queue.top();
+        queue.pop();
+        queued[rule] = 0;
+        
+        evaluateRule(rule);
+        evaluatedRuleCount++;
+    }
+}
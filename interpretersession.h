@@ -0,0 +1,66 @@
+#ifndef INTERPRETERSESSION_H
+#define INTERPRETERSESSION_H
+
+#include "interpreter.h"
+
+#include <queue>
+
+
+// Keeps the result of the last evaluation and, when an input changes,
+// re-evaluates only the Rules the change can reach.
+// Every Rule remembers which of its IF-Pairs hold, how many, and whether it fired; a revisited Rule checks again
+// only its IF-Pairs on the Variables that changed for it, so a Rule with many IF-Pairs costs no more than one.
+// Rules are revisited in evaluation order, so the result is the same as "Interpreter::interpret()".
+class InterpreterSession
+{
+public:
+    // "Interpreter" must outlive the session
+    explicit InterpreterSession(const Interpreter &interp);
+    
+public:
+    // Sets all inputs at once and evaluates every Rule
+    void reset(const QMap<QString, QString> &input);
+    
+    // Changes one input and re-evaluates only the affected Rules.
+    // Unknown Variables are ignored; Values outside of the domain mean "no value".
+    void setInput(const QString &varName, const QString &value);
+    void setInput(int varId, quint16 valueCode);
+    
+    // Value of the Variable after all Rules
+    quint16 getValue(int varId) const;
+    QMap<QString, QString> getOutput() const;
+    
+    // Number of Rules evaluated by the last "reset()" or "setInput()"
+    int getEvaluatedRuleCount() const;
+    
+private:
+    // Value the Rule sees: set by the last fired Rule before it, or taken from the input
+    quint16 valueBefore(int varId, int rule) const;
+    
+    void evaluateRule(int rule);
+    // Schedules Rules in (afterRule, lastRule] that read the Variable and marks their IF-Pairs on it
+    void scheduleReaders(int varId, int afterRule, int lastRule);
+    // First fired Rule after "afterRule" that assigns the Variable; rule count if none
+    int nextFiredWriter(int varId, int afterRule) const;
+    void propagate();
+    
+private:
+    const Interpreter &interp;
+    const RuleProgram &program;
+    
+    std::vector<quint16> inputs;
+    
+    // Per-Rule partial-match state; "pairStale" marks IF-Pairs to check again when their Rule is revisited
+    std::vector<quint8> pairHolds;
+    std::vector<quint8> pairStale;
+    std::vector<quint32> holdingPairs;
+    std::vector<quint8> fired;
+    
+    std::priority_queue<int, std::vector<int>, std::greater<int>> queue;
+    std::vector<quint8> queued;
+    
+    int evaluatedRuleCount;
+    
+};
+
+#endif // INTERPRETERSESSION_H
@@ -1,19 +1,22 @@
 #include "interpreterwindow.h"
 #include "ui_interpreterwindow.h"
 
-#include <cstdlib>
-#include <ctime>
-
 
 InterpreterWindow::InterpreterWindow(const Project &proj, QWidget *parent) :
     QWidget(parent),
     ui(new Ui::InterpreterWindow),
-    proj(proj),
-    interp(proj.getVarNames(), proj.getRules()),
+    interp(proj.getVarNames(), proj.getAllVarValues(), proj.getRules()),
+    session(interp),
     varNameMaxLength(0)
 {
     ui->setupUi(this);
     
+    for (const QString &var : interp.getRequiredInputVarList())
+    {
+        const QStringList *values = proj.getVarValues(var);
+        if (values) inputValues.insert(var, *values);
+    }
+    
     initialize();
 }
 
@@ -24,8 +27,6 @@ InterpreterWindow::~InterpreterWindow()
 
 void InterpreterWindow::initialize()
 {
-    std::srand(unsigned(std::time(0)));
-    
     QStringList inputVars = interp.getRequiredInputVarList();
     ui->varComboBox->addItems(inputVars);
     
@@ -34,16 +35,25 @@ void InterpreterWindow::initialize()
         varNameMaxLength = ((str.length() > varNameMaxLength) ? str.length() : varNameMaxLength);
     }
     
-    // Converting StringList to Map
-    for (int i = 0; i < inputVars.length(); i++)
+    // Inputs start unset; Values are needed only for Variables that the Rules actually test
+    for (const QString &var : inputVars)
     {
-        QStringList temp = *proj.getVarValues(inputVars.at(i));
-        
-        inputVarsMap[inputVars.at(i)] = temp.at(std::rand() % temp.length());
+        inputVarsMap[var] = QString();
     }
+    session.reset(inputVarsMap);
     
     refreshVarsAndValuesList();
     ui->errorsEdit->setText(Error(ErrorCode::NoErrors).text());
+    
+    QStringList unreachableRules;
+    for (int ruleId : interp.getUnreachableRuleList())
+    {
+        unreachableRules.append(QString::number(ruleId + 1));
+    }
+    if (!unreachableRules.isEmpty())
+    {
+        ui->errorsEdit->setText(tr("These Rules will never be evaluated, because some of their IF-Variables are never assigned: ") + unreachableRules.join(", "));
+    }
 }
 
 void InterpreterWindow::refreshVarsAndValuesList()
@@ -62,38 +72,54 @@ void InterpreterWindow::on_varComboBox_currentIndexChanged(const QString &arg1)
 {
     if (arg1.isEmpty()) return;
     
-    auto result = proj.getVarValues(arg1);
-    if (!result) return;
+    auto result = inputValues.constFind(arg1);
+    if (result == inputValues.constEnd()) return;
     
     ui->valueComboBox->clear();
-    ui->valueComboBox->addItems(*result);
+    // Empty entry unsets the Variable
+    ui->valueComboBox->addItem(QString());
+    ui->valueComboBox->addItems(result.value());
     ui->errorsEdit->setText(Error(ErrorCode::NoErrors).text());
 }
 
 void InterpreterWindow::on_enterButton_clicked()
 {
     if (ui->varComboBox->currentText().isEmpty()) return;
-    if (ui->valueComboBox->currentText().isEmpty()) return;
     
     inputVarsMap[ui->varComboBox->currentText()] = ui->valueComboBox->currentText();
+    // Only Rules depending on this Variable are evaluated again
+    session.setInput(ui->varComboBox->currentText(), ui->valueComboBox->currentText());
     refreshVarsAndValuesList();
 }
 
 void InterpreterWindow::on_interpretButton_clicked()
 {
-    for (auto value : inputVarsMap)
+    QMap<QString, QString> result;
+    
+    if (inputVarsMap.values().contains(QString()))
     {
-        if (value.isEmpty())
+        // Values are needed only for Variables that some Rule actually tests
+        QStringList missingVars;
+        result = interp.interpretGoals(interp.getOutputVarList(), [&](const QString &var)
+        {
+            QString value = inputVarsMap.value(var);
+            if (value.isEmpty()) missingVars.append(var);
+            return value;
+        });
+        
+        if (!missingVars.isEmpty())
         {
-            ui->errorsEdit->setText("You should enter value for all Variables.");
+            ui->errorsEdit->setText(tr("You should enter value for these Variables: ") + missingVars.join(", "));
             return;
         }
     }
+    else
+    {
+        result = session.getOutput();
+    }
     
     ui->errorsEdit->setText(Error(ErrorCode::NoErrors).text());
     
-    QMap<QString, QString> result = interp.interpret(inputVarsMap);
-    
     resWindow = new ResultWindow(result);
     resWindow->show();
 }
@@ -1,10 +1,12 @@
 #ifndef INTERPRETERWINDOW_H
 #define INTERPRETERWINDOW_H
 
+#include <QHash>
 #include <QWidget>
 
 #include "project.h"
 #include "interpreter.h"
+#include "interpretersession.h"
 #include "resultwindow.h"
 
 
@@ -34,8 +36,10 @@ private:
 private:
     Ui::InterpreterWindow *ui;
     
-    Project proj;
+    // Declared Values of the Input Variables; the Project itself may change or close meanwhile
+    QHash<QString, QStringList> inputValues;
     Interpreter interp;
+    InterpreterSession session;
     ResultWindow *resWindow;
     
     QMap<QString, QString> inputVarsMap;
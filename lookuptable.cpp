@@ -0,0 +1,175 @@
+#include "lookuptable.h"
+#include "workstealingpool.h"
+
+#include <algorithm>
+
+
+LookupTable::LookupTable(const Interpreter &interp, qint64 maxTableBytes, int threadCount) :
+    interp(interp),
+    entryCount(1)
+{
+    const SymbolTable &symbols = interp.getSymbols();
+    qint64 outputCount = static_cast<qint64>(interp.getOutputVarIds().size());
+    qint64 maxEntries = maxTableBytes / static_cast<qint64>(sizeof(quint16)) / qMax(outputCount, qint64(1));
+    
+    // First Input Variable changes fastest
+    for (int varId : interp.getInputVarIds())
+    {
+        quint32 radix = static_cast<quint32>(symbols.getDomainSize(varId)) + 1;
+        radixes.push_back(radix);
+        strides.push_back(entryCount);
+        
+        if (entryCount > maxEntries / radix)
+        {
+            entryCount = -1;
+            return;
+        }
+        entryCount *= radix;
+    }
+    
+    build(threadCount);
+}
+
+bool LookupTable::isCompiled() const
+{
+    return entryCount != -1;
+}
+
+qint64 LookupTable::getEntryCount() const
+{
+    return entryCount;
+}
+
+QMap<QString, QString> LookupTable::interpret(const QMap<QString, QString> &input) const
+{
+    if (!isCompiled()) return interp.interpret(input);
+    
+    const SymbolTable &symbols = interp.getSymbols();
+    const std::vector<int> &inputVarIds = interp.getInputVarIds();
+    const std::vector<int> &outputVarIds = interp.getOutputVarIds();
+    
+    qint64 index = 0;
+    int found = 0;
+    for (int k = 0; k < static_cast<int>(inputVarIds.size()); k++)
+    {
+        auto it = input.constFind(symbols.getVarName(inputVarIds[k]));
+        if (it == input.constEnd()) continue;
+        index += symbols.getValueCode(inputVarIds[k], it.value()) * strides[k];
+        found++;
+    }
+    
+    // Preset Values of other known Variables are not covered by the table
+    if (found != input.size())
+    {
+        for (auto it = input.constBegin(); it != input.constEnd(); ++it)
+        {
+            int varId = symbols.getVarId(it.key());
+            if (varId == -1) continue;
+            if (std::find(inputVarIds.begin(), inputVarIds.end(), varId) == inputVarIds.end()) return interp.interpret(input);
+        }
+    }
+    
+    QMap<QString, QString> output;
+    for (int k = 0; k < static_cast<int>(outputVarIds.size()); k++)
+    {
+        output[symbols.getVarName(outputVarIds[k])] = symbols.getValueName(outputVarIds[k], table[k * entryCount + index]);
+    }
+    
+    return output;
+}
+
+QStringList LookupTable::interpretAndStringify(const QMap<QString, QString> &input) const
+{
+    auto output = interpret(input);
+    
+    QStringList result;
+    
+    foreach (auto key, output.keys())
+    {
+        result.append(key + " <= " + output.value(key));
+    }
+    
+    return result;
+}
+
+void LookupTable::interpretBatch(const Interpreter::BatchInput &input, Interpreter::BatchOutput &output, int firstRow, int rowCount) const
+{
+    if (!isCompiled())
+    {
+        interp.interpretBatch(input, output, firstRow, rowCount);
+        return;
+    }
+    
+    if (rowCount == -1) rowCount = input.rowCount - firstRow;
+    
+    int inputCount = static_cast<int>(radixes.size());
+    int outputCount = static_cast<int>(output.columns.size());
+    
+    for (int row = firstRow; row < firstRow + rowCount; row++)
+    {
+        qint64 index = 0;
+        bool inDomain = true;
+        for (int k = 0; k < inputCount; k++)
+        {
+            quint16 code = input.columns[k][row];
+            if (code >= radixes[k]) inDomain = false;
+            index += code * strides[k];
+        }
+        
+        // Codes out of the domain have no entry
+        if (!inDomain)
+        {
+            interp.interpretBatch(input, output, row, 1);
+            continue;
+        }
+        
+        for (int k = 0; k < outputCount; k++)
+        {
+            output.columns[k][row] = table[k * entryCount + index];
+        }
+    }
+}
+
+void LookupTable::build(int threadCount)
+{
+    int inputCount = static_cast<int>(radixes.size());
+    int outputCount = static_cast<int>(interp.getOutputVarIds().size());
+    table.resize(static_cast<size_t>(entryCount) * outputCount);
+    
+    const qint64 chunkSize = 4096;
+    int chunkCount = static_cast<int>((entryCount + chunkSize - 1) / chunkSize);
+    
+    // Every chunk decodes its indices into Input columns and writes its rows of the table directly
+    WorkStealingPool pool(threadCount);
+    pool.run(chunkCount, [&](int chunk)
+    {
+        qint64 first = chunk * chunkSize;
+        int rows = static_cast<int>(qMin(chunkSize, entryCount - first));
+        
+        std::vector<std::vector<quint16>> inputColumns(inputCount, std::vector<quint16>(rows));
+        for (int row = 0; row < rows; row++)
+        {
+            qint64 index = first + row;
+            for (int k = 0; k < inputCount; k++)
+            {
+                inputColumns[k][row] = static_cast<quint16>(index % radixes[k]);
+                index /= radixes[k];
+            }
+        }
+        
+        Interpreter::BatchInput input;
+        input.rowCount = rows;
+        for (auto &column : inputColumns)
+        {
+            input.columns.push_back(column.data());
+        }
+        
+        Interpreter::BatchOutput output;
+        for (int k = 0; k < outputCount; k++)
+        {
+            output.columns.push_back(table.data() + k * entryCount + first);
+        }
+        
+        interp.interpretBatch(input, output);
+    });
+}
@@ -0,0 +1,44 @@
+#ifndef LOOKUPTABLE_H
+#define LOOKUPTABLE_H
+
+#include "interpreter.h"
+
+#include <vector>
+
+
+// Outputs of the Interpreter precomputed for every combination of Input Values.
+// Input Value codes (with "0" for unset Variables) form a mixed-radix index into the table,
+// so interpretation is one load per Output Variable.
+// When the table would be larger than the limit it is not built and the Interpreter is used directly.
+class LookupTable
+{
+public:
+    // "Interpreter" must outlive the table; "0" threads means one thread per core
+    explicit LookupTable(const Interpreter &interp, qint64 maxTableBytes = 64 * 1024 * 1024, int threadCount = 0);
+    
+public:
+    bool isCompiled() const;
+    // Number of Input combinations, "-1" if it exceeds the limit
+    qint64 getEntryCount() const;
+    
+    QMap<QString, QString> interpret(const QMap<QString, QString> &input) const;
+    QStringList interpretAndStringify(const QMap<QString, QString> &input) const;
+    // Same layout as "Interpreter::interpretBatch()"
+    void interpretBatch(const Interpreter::BatchInput &input, Interpreter::BatchOutput &output, int firstRow = 0, int rowCount = -1) const;
+    
+private:
+    void build(int threadCount);
+    
+private:
+    const Interpreter &interp;
+    
+    qint64 entryCount;
+    // "radixes[k]" is domain size of k-th Input Variable plus unset Value
+    std::vector<quint32> radixes;
+    std::vector<qint64> strides;
+    // Column of every Output Variable, "table[k * entryCount + index]"
+    std::vector<quint16> table;
+    
+};
+
+#endif // LOOKUPTABLE_H
@@ -11,7 +11,8 @@
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
     ui(new Ui::MainWindow),
-    proj(nullptr)
+    proj(nullptr),
+    saver(nullptr)
 {
     ui->setupUi(this);
     
@@ -20,6 +21,7 @@ MainWindow::MainWindow(QWidget *parent) :
 
 MainWindow::~MainWindow()
 {
+    delete saver;
     delete proj;
     //delete interpWindow;
     delete ui;
@@ -34,12 +36,16 @@ void MainWindow::closeEvent(QCloseEvent *event)
             event->ignore();
             return;
         }
+        if (proj->isSaved()) proj->compact();
     }
     event->accept();
 }
 
 void MainWindow::onProjectOpened()
 {
+    saver = new ProjectSaver(this);
+    connect(saver, &ProjectSaver::finished, this, &MainWindow::onSnapshotSaved);
+    
     windowTitle = proj->getProjName() + " - ES IDE";
     this->setWindowTitle(windowTitle);
     
@@ -47,6 +53,7 @@ void MainWindow::onProjectOpened()
     ui->actionOpen_Project->setDisabled(true);
     
     ui->actionSave_Project->setEnabled(true);
+    ui->actionExport_Project->setEnabled(true);
     ui->actionClose_Project->setEnabled(true);
     ui->actionInterpret->setEnabled(true);
     ui->tabWidget->setEnabled(true);
@@ -54,13 +61,90 @@ void MainWindow::onProjectOpened()
     ui->varList->addItems(proj->getVarNames());
     ui->varErrorsEdit->setText(Error(ErrorCode::NoErrors).text());
     
-    ui->ruleList->addItems(proj->getRulezzStringified());
+    fillRuleList();
     ui->ruleErrorsEdit->setText(Error(ErrorCode::NoErrors).text());
     
 }
 
+void MainWindow::fillRuleList()
+{
+    ui->ruleList->clear();
+    QStringList rulezz = proj->getRulezzStringified();
+    for (int i = 0; i < rulezz.length(); i++)
+    {
+        QListWidgetItem *item = new QListWidgetItem(rulezz.at(i));
+        item->setData(Qt::UserRole, proj->getRuleKey(i));
+        ui->ruleList->addItem(item);
+    }
+}
+
+void MainWindow::updateRuleItem(QListWidgetItem *item)
+{
+    item->setText(proj->getRuleStringifiedByKey(ruleKey(item)));
+}
+
+quint64 MainWindow::ruleKey(const QListWidgetItem *item) const
+{
+    return item->data(Qt::UserRole).toULongLong();
+}
+
+void MainWindow::updateRuleItems(const QList<quint64> &ruleKeys)
+{
+    for (quint64 key : ruleKeys)
+    {
+        int row = proj->getRuleId(key);
+        if (row != -1) updateRuleItem(ui->ruleList->item(row));
+    }
+    
+    QListWidgetItem *current = ui->ruleList->currentItem();
+    if (current && ruleKeys.contains(ruleKey(current)))
+    {
+        ui->ifBlockEdit->setText(proj->getRuleByKey(ruleKey(current))->stringifyIfBlock());
+        ui->thenBlockEdit->setText(proj->getRuleByKey(ruleKey(current))->stringifyThenBlock());
+    }
+}
+
+void MainWindow::updateRuleItemsAfterDelete(const QList<quint64> &ruleKeys, int oldRuleCount)
+{
+    int deletedCount = oldRuleCount - proj->getRules().length();
+    if (deletedCount == 0)
+    {
+        updateRuleItems(ruleKeys);
+        ui->ruleErrorsEdit->setText(Error(ErrorCode::NoErrors).text());
+        return;
+    }
+    
+    // Rules after the deleted ones are renumbered
+    fillRuleList();
+    ui->ifBlockEdit->clear();
+    ui->thenBlockEdit->clear();
+    ui->ruleErrorsEdit->setText(tr("%n Rule(s) deleted, their IF-Pairs can not hold any more", "", deletedCount));
+}
+
+void MainWindow::showVarUsage()
+{
+    QString text = Error(ErrorCode::NoErrors).text();
+    if (ui->varList->currentItem())
+    {
+        QString varName = ui->varList->currentItem()->text();
+        text.append("\n" + tr("Variable is used by %n Rule(s)", "", proj->getVarRuleCount(varName)));
+        if (ui->valueList->currentItem())
+        {
+            int count = proj->getValueRuleCount(varName, ui->valueList->currentItem()->text());
+            text.append("\n" + tr("Value is used by %n Rule(s)", "", count));
+        }
+    }
+    ui->varErrorsEdit->setText(text);
+}
+
 void MainWindow::onProjectClosed()
 {
+    // Waits for a running save; its result is not needed any more
+    delete saver;
+    saver = nullptr;
+    
+    // Saved edits are moved from the Journal into the Project Files
+    if (proj && proj->isSaved()) proj->compact();
     delete proj;
     proj = nullptr;
     
@@ -70,6 +154,7 @@ void MainWindow::onProjectClosed()
     ui->actionOpen_Project->setEnabled(true);
     
     ui->actionSave_Project->setDisabled(true);
+    ui->actionExport_Project->setDisabled(true);
     ui->actionClose_Project->setDisabled(true);
     ui->actionInterpret->setDisabled(true);
     ui->tabWidget->setDisabled(true);
@@ -93,8 +178,24 @@ void MainWindow::onProjectClosed()
     
 }
 
+void MainWindow::onSnapshotSaved(quint64 revision, bool ok)
+{
+    if (!ok)
+    {
+        ui->varErrorsEdit->setText(Error(ErrorCode::FileError).text());
+        return;
+    }
+    
+    // Edits made while the snapshot was being written keep the Project unsaved
+    proj->setSnapshotSaved(revision);
+    if (proj->isSaved()) setWindowTitle(windowTitle);
+}
+
 bool MainWindow::askCloseProject()
 {
+    // "isSaved()" is only final once a running save has finished
+    saver->wait();
+    
     if (!proj->isSaved())
     {
         QMessageBox msgBox;
@@ -106,7 +207,11 @@ bool MainWindow::askCloseProject()
         
         switch (ret) {
         case QMessageBox::Save:
-            proj->saveProject();
+            if (Error err = proj->saveProject())
+            {
+                QMessageBox::warning(this, tr("Save Project"), err.text());
+                return false;
+            }
             break;
         case QMessageBox::Cancel:
             return false;
@@ -130,23 +235,54 @@ void MainWindow::on_actionNew_Project_triggered()
 
 void MainWindow::on_actionOpen_Project_triggered()
 {
-    QString selectedFilter = tr("ES Projects (*.esp)");
-    QString path = QFileDialog::getOpenFileName(this, tr("Open Project"), QString(), tr("ES Projects (*.esp);;All files (*.*)"), &selectedFilter);
+    QString selectedFilter = tr("ES Projects (*.esp *.esb)");
+    QString path = QFileDialog::getOpenFileName(this, tr("Open Project"), QString(), tr("ES Projects (*.esp *.esb);;All files (*.*)"), &selectedFilter);
     
     if (path.isNull()) return;
     
     proj = new Project(path);
     
+    if (proj->getLoadError())
+    {
+        QMessageBox::warning(this, tr("Open Project"), proj->getLoadError().text());
+        // Skipped lines are only reported; the rest of the Project is usable
+        if (proj->getLoadError().getCode() != ErrorCode::ParseError)
+        {
+            delete proj;
+            proj = nullptr;
+            return;
+        }
+    }
+    
     onProjectOpened();
 }
 
 void MainWindow::on_actionSave_Project_triggered()
 {
-    setWindowTitle(windowTitle);
+    // Committing the Journal is enough; Project Files are rewritten only without Journal or once it has grown large
+    bool committed = proj->commitJournal();
+    if (committed)
+    {
+        setWindowTitle(windowTitle);
+        ui->varErrorsEdit->setText(Error(ErrorCode::NoErrors).text());
+    }
+    
+    // Project Files are written on another thread, so editing goes on meanwhile; see "onSnapshotSaved"
+    if (!committed || proj->needsCompaction()) saver->save(proj->snapshot());
+}
+
+void MainWindow::on_actionExport_Project_triggered()
+{
+    QString textFilter = tr("ES Projects (*.esp)");
+    QString binaryFilter = tr("ES Binary Projects (*.esb)");
+    QString selectedFilter = (proj->getFormat() == ProjectFormat::Text ? binaryFilter : textFilter);
+    QString path = QFileDialog::getSaveFileName(this, tr("Export Project"), QString(), textFilter + ";;" + binaryFilter, &selectedFilter);
     
-    proj->saveProject();
+    if (path.isNull()) return;
     
-    ui->varErrorsEdit->setText(Error(ErrorCode::NoErrors).text());
+    ProjectFormat format = (selectedFilter == binaryFilter ? ProjectFormat::Binary : ProjectFormat::Text);
+    Error err = proj->exportProject(path, format);
+    if (err) QMessageBox::warning(this, tr("Export Project"), err.text());
 }
 
 void MainWindow::on_actionClose_Project_triggered()
@@ -189,7 +325,7 @@ void MainWindow::on_varList_currentItemChanged(QListWidgetItem *current, QListWi
     
     ui->valueList->clear();
     ui->valueList->addItems(*proj->getVarValues(current->text()));
-    ui->varErrorsEdit->setText(Error(ErrorCode::NoErrors).text());
+    showVarUsage();
 }
 
 void MainWindow::on_valueList_currentItemChanged(QListWidgetItem *current, QListWidgetItem *previous)
@@ -202,7 +338,7 @@ void MainWindow::on_valueList_currentItemChanged(QListWidgetItem *current, QList
     {
         ui->varValueEdit->clear();
     }
-    ui->varErrorsEdit->setText(Error(ErrorCode::NoErrors).text());
+    showVarUsage();
 }
 
 void MainWindow::on_addVarButton_clicked()
@@ -235,6 +371,7 @@ void MainWindow::on_addValueButton_clicked()
 void MainWindow::on_renameVarButton_clicked()
 {
     if (!ui->varList->currentItem()) return;
+    QList<quint64> ruleKeys = proj->getVarRules(ui->varList->currentItem()->text());
     Error err = proj->setVarName(ui->varNameEdit->text(), ui->varList->currentItem()->text());
     if (err)
     {
@@ -243,12 +380,14 @@ void MainWindow::on_renameVarButton_clicked()
     }
     ui->varErrorsEdit->setText(err.text());
     ui->varList->currentItem()->setText(ui->varNameEdit->text());
+    updateRuleItems(ruleKeys);
     this->setWindowTitle("* " + windowTitle);
 }
 
 void MainWindow::on_renameValueButton_clicked()
 {
     if (!ui->valueList->currentItem()) return;
+    QList<quint64> ruleKeys = proj->getValueRules(ui->varList->currentItem()->text(), ui->valueList->currentItem()->text());
     Error err = proj->setVarValue(ui->varValueEdit->text(), ui->varList->currentItem()->text(), ui->valueList->currentItem()->text());
     if (err)
     {
@@ -257,13 +396,17 @@ void MainWindow::on_renameValueButton_clicked()
     }
     ui->varErrorsEdit->setText(err.text());
     ui->valueList->currentItem()->setText(ui->varValueEdit->text());
+    updateRuleItems(ruleKeys);
     this->setWindowTitle("* " + windowTitle);
 }
 
 void MainWindow::on_deleteVarButton_clicked()
 {
     if (!ui->varList->currentItem()) return;
+    QList<quint64> ruleKeys = proj->getVarRules(ui->varList->currentItem()->text());
+    int ruleCount = proj->getRules().length();
     proj->deleteVar(ui->varList->currentItem()->text());
+    updateRuleItemsAfterDelete(ruleKeys, ruleCount);
     //ui->varList->removeItemWidget(ui->varList->currentItem());
     delete ui->varList->currentItem();
     ui->varList->setCurrentItem(nullptr);
@@ -277,7 +420,10 @@ void MainWindow::on_deleteVarButton_clicked()
 void MainWindow::on_deleteValueButton_clicked()
 {
     if (!ui->valueList->currentItem()) return;
+    QList<quint64> ruleKeys = proj->getValueRules(ui->varList->currentItem()->text(), ui->valueList->currentItem()->text());
+    int ruleCount = proj->getRules().length();
     proj->deleteVarValue(ui->varList->currentItem()->text(), ui->valueList->currentItem()->text());
+    updateRuleItemsAfterDelete(ruleKeys, ruleCount);
     //ui->valueList->removeItemWidget(ui->valueList->currentItem());
     delete ui->valueList->currentItem();
     ui->valueList->setCurrentItem(nullptr);
@@ -290,7 +436,7 @@ void MainWindow::on_ruleList_currentItemChanged(QListWidgetItem *current, QListW
 {
     if (!current) return;
     
-    auto rule = proj->getRule(current->text());
+    auto rule = proj->getRuleByKey(ruleKey(current));
     
     ui->ifBlockEdit->setText(rule->stringifyIfBlock());
     ui->thenBlockEdit->setText(rule->stringifyThenBlock());
@@ -299,13 +445,20 @@ void MainWindow::on_ruleList_currentItemChanged(QListWidgetItem *current, QListW
     ui->varIfComboBox->addItems(proj->getVarNames());
     ui->varThenComboBox->clear();
     ui->varThenComboBox->addItems(proj->getVarNames());
-    ui->ruleErrorsEdit->setText(Error(ErrorCode::NoErrors).text());
 }
 
 void MainWindow::on_addRuleButton_clicked()
 {
+    int width = proj->getRuleStringified(0).indexOf(')');
     proj->addRule(Rule());
-    ui->ruleList->addItem(proj->getRuleStringified());
+    // Numbers of all Rules are padded to the width of the largest one
+    if (proj->getRuleStringified(0).indexOf(')') != width) fillRuleList();
+    else
+    {
+        QListWidgetItem *item = new QListWidgetItem(proj->getRuleStringified());
+        item->setData(Qt::UserRole, proj->getRuleKey());
+        ui->ruleList->addItem(item);
+    }
     this->setWindowTitle("* " + windowTitle);
     ui->ruleErrorsEdit->setText(Error(ErrorCode::NoErrors).text());
 }
@@ -314,9 +467,20 @@ void MainWindow::on_deleteRuleButton_clicked()
 {
     if (!ui->ruleList->currentItem()) return;
     
-    proj->deleteRule(ui->ruleList->currentItem()->text());
-    ui->ruleList->clear();
-    ui->ruleList->addItems(proj->getRulezzStringified());
+    int row = ui->ruleList->currentRow();
+    int width = proj->getRuleStringified(0).indexOf(')');
+    proj->deleteRuleByKey(ruleKey(ui->ruleList->currentItem()));
+    ui->ruleList->setCurrentItem(nullptr);
+    delete ui->ruleList->takeItem(row);
+    // Only Rules after the deleted one are renumbered, unless the padding has changed
+    if (proj->getRuleStringified(0).indexOf(')') != width) fillRuleList();
+    else
+    {
+        for (int i = row; i < ui->ruleList->count(); i++)
+        {
+            updateRuleItem(ui->ruleList->item(i));
+        }
+    }
     
     ui->ifBlockEdit->clear();
     ui->varIfComboBox->clear();
@@ -351,9 +515,10 @@ void MainWindow::on_backspaceIfButton_clicked()
 {
     if (!ui->ruleList->currentItem()) return;
     
-    proj->deleteIfPair(ui->ruleList->currentItem()->text());
-    ui->ruleList->currentItem()->setText(proj->getRuleStringified(ui->ruleList->currentItem()->text()));
-    ui->ifBlockEdit->setText(proj->getRule(ui->ruleList->currentItem()->text())->stringifyIfBlock());
+    QListWidgetItem *item = ui->ruleList->currentItem();
+    proj->deleteIfPairByKey(ruleKey(item));
+    updateRuleItem(item);
+    ui->ifBlockEdit->setText(proj->getRuleByKey(ruleKey(item))->stringifyIfBlock());
     
     this->setWindowTitle("* " + windowTitle);
 }
@@ -364,7 +529,7 @@ void MainWindow::on_enterIfButton_clicked()
     if (ui->varIfComboBox->currentText().isEmpty()) return;
     if (ui->valueIfComboBox->currentText().isEmpty()) return;
     
-    Error err = proj->addIfPair(Pair(ui->varIfComboBox->currentText(), ui->valueIfComboBox->currentText()), ui->ruleList->currentItem()->text());
+    Error err = proj->addIfPairByKey(Pair(ui->varIfComboBox->currentText(), ui->valueIfComboBox->currentText()), ruleKey(ui->ruleList->currentItem()));
     if (err)
     {
         ui->ruleErrorsEdit->setText(tr("Add Pair Error!") + "\n\n" + err.text());
@@ -372,8 +537,8 @@ void MainWindow::on_enterIfButton_clicked()
     }
     ui->ruleErrorsEdit->setText(err.text());
     
-    ui->ruleList->currentItem()->setText(proj->getRuleStringified(ui->ruleList->currentItem()->text()));
-    ui->ifBlockEdit->setText(proj->getRule(ui->ruleList->currentItem()->text())->stringifyIfBlock());
+    updateRuleItem(ui->ruleList->currentItem());
+    ui->ifBlockEdit->setText(proj->getRuleByKey(ruleKey(ui->ruleList->currentItem()))->stringifyIfBlock());
     
     this->setWindowTitle("* " + windowTitle);
 }
@@ -399,9 +564,10 @@ void MainWindow::on_backspaceThenButton_clicked()
 {
     if (!ui->ruleList->currentItem()) return;
     
-    proj->deleteThenPair(ui->ruleList->currentItem()->text());
-    ui->ruleList->currentItem()->setText(proj->getRuleStringified(ui->ruleList->currentItem()->text()));
-    ui->thenBlockEdit->setText(proj->getRule(ui->ruleList->currentItem()->text())->stringifyThenBlock());
+    QListWidgetItem *item = ui->ruleList->currentItem();
+    proj->deleteThenPairByKey(ruleKey(item));
+    updateRuleItem(item);
+    ui->thenBlockEdit->setText(proj->getRuleByKey(ruleKey(item))->stringifyThenBlock());
     
     this->setWindowTitle("* " + windowTitle);
 }
@@ -412,7 +578,7 @@ void MainWindow::on_enterThenButton_clicked()
     if (ui->varThenComboBox->currentText().isEmpty()) return;
     if (ui->valueThenComboBox->currentText().isEmpty()) return;
     
-    Error err = proj->addThenPair(Pair(ui->varThenComboBox->currentText(), ui->valueThenComboBox->currentText()), ui->ruleList->currentItem()->text());
+    Error err = proj->addThenPairByKey(Pair(ui->varThenComboBox->currentText(), ui->valueThenComboBox->currentText()), ruleKey(ui->ruleList->currentItem()));
     if (err)
     {
         ui->ruleErrorsEdit->setText(tr("Add Pair Error!") + "\n\n" + err.text());
@@ -420,8 +586,8 @@ void MainWindow::on_enterThenButton_clicked()
     }
     ui->ruleErrorsEdit->setText(err.text());
     
-    ui->ruleList->currentItem()->setText(proj->getRuleStringified(ui->ruleList->currentItem()->text()));
-    ui->thenBlockEdit->setText(proj->getRule(ui->ruleList->currentItem()->text())->stringifyThenBlock());
+    updateRuleItem(ui->ruleList->currentItem());
+    ui->thenBlockEdit->setText(proj->getRuleByKey(ruleKey(ui->ruleList->currentItem()))->stringifyThenBlock());
     
     this->setWindowTitle("* " + windowTitle);
 }
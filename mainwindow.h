@@ -2,6 +2,7 @@
 #define MAINWINDOW_H
 
 #include "project.h"
+#include "projectsaver.h"
 #include "interpreterwindow.h"
 
 #include <QMainWindow>
@@ -24,6 +25,8 @@ private:
     Ui::MainWindow *ui;
     
     Project *proj;
+    // Writes Project Files in the background; exists while a Project is open
+    ProjectSaver *saver;
     InterpreterWindow *interpWindow;
     QString windowTitle;
     
@@ -32,15 +35,28 @@ private:
 private:
     void closeEvent(QCloseEvent *event);
     
+    // Rule List items keep the key of their Rule, see "Project::getRuleKey()"
+    void fillRuleList();
+    void updateRuleItem(QListWidgetItem *item);
+    quint64 ruleKey(const QListWidgetItem *item) const;
+    // Refreshes the Rules changed by renaming or deleting a Variable or Value
+    void updateRuleItems(const QList<quint64> &ruleKeys);
+    // Same after deleting a Variable or Value, which deletes the Rules testing it; "oldRuleCount" is taken before
+    void updateRuleItemsAfterDelete(const QList<quint64> &ruleKeys, int oldRuleCount);
+    // Shows how many Rules use the current Variable and Value
+    void showVarUsage();
+    
 private slots:
     void onProjectOpened();
     void onProjectClosed();
+    void onSnapshotSaved(quint64 revision, bool ok);
     
     bool askCloseProject();
     
     void on_actionNew_Project_triggered();
     void on_actionOpen_Project_triggered();
     void on_actionSave_Project_triggered();
+    void on_actionExport_Project_triggered();
     void on_actionClose_Project_triggered();
     void on_actionExit_triggered();
     
@@ -1,13 +1,19 @@
 #include "project.h"
+#include "binaryprojectfile.h"
+#include "textprojectparser.h"
+#include "projectjournal.h"
 
 #include <QFile>
 #include <QIODevice>
 #include <QStringList>
 #include <QDebug>
 #include <QDir>
+#include <QFileInfo>
 #include <QSaveFile>
 #include <QtMath>
 
+#include <algorithm>
+
 
 Error::Error(ErrorCode errCode) : errCode(errCode)
 {
@@ -42,9 +48,20 @@ Error::Error(ErrorCode errCode) : errCode(errCode)
     case ErrorCode::PairAlreadyExists:
         message = QCoreApplication::translate("Error", "Pair already exists.");
         break;
+    case ErrorCode::FileError:
+        message = QCoreApplication::translate("Error", "Project File can not be read or written.");
+        break;
+    case ErrorCode::ParseError:
+        message = QCoreApplication::translate("Error", "Malformed lines in Project File were skipped.");
+        break;
     }
 }
 
+Error::Error(ErrorCode errCode, const QString &details) : Error(errCode)
+{
+    message.append("\n" + details);
+}
+
 Pair::Pair()
 {
     
@@ -99,87 +116,170 @@ QString Rule::stringifyThenBlock() const
     return result;
 }
 
-// Constructor for Existing Project; we pass path to ".esp" file
+namespace
+{
+
+// Maps every String to its first position in "list"
+QHash<QString, int> indexList(const QStringList &list)
+{
+    QHash<QString, int> index;
+    index.reserve(list.length());
+    for (int i = list.length() - 1; i >= 0; i--)
+    {
+        index.insert(list.at(i), i);
+    }
+    return index;
+}
+
+// "name" was removed from "list" at "removed"; the Strings after it have moved one place up
+void removeFromIndex(QHash<QString, int> *index, const QStringList &list, int removed, const QString &name)
+{
+    if (index->value(name) == removed) index->remove(name);
+    for (int i = removed; i < list.length(); i++)
+    {
+        QHash<QString, int>::iterator it = index->find(list.at(i));
+        // A later duplicate of "name" becomes its first occurrence
+        if (it == index->end()) index->insert(list.at(i), i);
+        else if (it.value() > i) it.value() = i;
+    }
+}
+
+// String at "id" in "list" was "oldName"; the new one is not in "list" elsewhere
+void renameInIndex(QHash<QString, int> *index, const QStringList &list, int id, const QString &oldName)
+{
+    if (index->value(oldName) == id)
+    {
+        // Only Files edited by hand have duplicates, and then the index is smaller than the List
+        int other = (index->size() < list.length() ? list.indexOf(oldName, id + 1) : -1);
+        if (other == -1) index->remove(oldName);
+        else index->insert(oldName, other);
+    }
+    index->insert(list.at(id), id);
+}
+
+// One Pair of Rule "ruleKey" referring to "key" is gone
+template<typename Key>
+void unref(QHash<Key, QHash<quint64, int>> *refs, const Key &key, quint64 ruleKey)
+{
+    typename QHash<Key, QHash<quint64, int>>::iterator it = refs->find(key);
+    if (it == refs->end()) return;
+    QHash<quint64, int>::iterator r = it.value().find(ruleKey);
+    if (r == it.value().end()) return;
+    if (--r.value() == 0) it.value().erase(r);
+    if (it.value().isEmpty()) refs->erase(it);
+}
+
+}
+
+// Constructor for Existing Project; we pass path to ".esp" or ".esb" file
 Project::Project(const QString &projFilePath)
-    : projFilePath(projFilePath), regexpIdentifier("[_a-zA-Z][_a-zA-Z0-9]*")
+    : projFilePath(projFilePath), regexpIdentifier("[_a-zA-Z][_a-zA-Z0-9]*"), format(ProjectFormat::Text), loadError(ErrorCode::NoErrors),
+      nextRuleKey(1), revision(0), baseRevision(0), replaying(false), savedRevision(0)
+{
+    if (BinaryProjectFile::isBinaryProjectFile(projFilePath))
+    {
+        format = ProjectFormat::Binary;
+        if (!loadBinary()) loadError = Error(ErrorCode::FileError);
+    }
+    else
+    {
+        if (!loadText()) loadError = Error(ErrorCode::FileError);
+    }
+    buildIndices();
+    
+    revision = baseRevision;
+    if (loadError.getCode() != ErrorCode::FileError) openJournal();
+    
+    savedRevision = revision;
+}
+
+bool Project::loadText()
 {
     QFile projFile(projFilePath);
-    projFile.open(QFile::ReadOnly);
+    if (!projFile.open(QFile::ReadOnly)) return false;
     
     QTextStream projFileStream(&projFile);
     
     QString projFolder(projFilePath.mid(0, projFilePath.lastIndexOf("/", -1) + 1));
     projName = projFileStream.readLine();
-    
-    // Start loading variables
     varFilePath = projFolder + projFileStream.readLine();
+    rulFilePath = projFolder + projFileStream.readLine();
+    // Older Projects have no revision line
+    baseRevision = projFileStream.readLine().toULongLong();
+    projFile.close();
     
-    QFile varFile(varFilePath);
-    varFile.open(QFile::ReadOnly);
+    TextProjectParser parser;
+    if (!parser.parseVarFile(varFilePath, &varNames, &varValues)) return false;
+    if (!parser.parseRulFile(rulFilePath, &rules)) return false;
     
-    QTextStream varFileStream(&varFile);
+    if (parser.getErrorCount() > 0)
+    {
+        QStringList details = parser.getErrors();
+        int more = parser.getErrorCount() - details.length();
+        if (more > 0) details.append(QString("... ") + QString::number(more) + " more");
+        loadError = Error(ErrorCode::ParseError, details.join("\n"));
+    }
+    
+    return true;
+}
+
+bool Project::loadBinary()
+{
+    BinaryProjectFile file;
+    if (!file.open(projFilePath)) return false;
+    baseRevision = file.getRevision();
     
-    while (!varFileStream.atEnd())
+    // Every String is converted once; Variables, Values and Pairs share it
+    std::vector<QString> strings(file.getStringCount());
+    for (int i = 0; i < file.getStringCount(); i++)
     {
-        QStringList line = varFileStream.readLine().split(".");
-        
-        varNames.append(line.at(0));
+        strings[i] = file.getString(i);
+    }
+    
+    projName = strings[file.getProjName()];
+    
+    int varCount = file.getVarCount();
+    varNames.reserve(varCount);
+    varValues.reserve(varCount);
+    for (int i = 0; i < varCount; i++)
+    {
+        varNames.append(strings[file.getVarName(i)]);
         
         QStringList valueBlock;
-        
-        for (int i = 1; i < line.length(); i++)
+        int valueCount = file.getValueCount(i);
+        valueBlock.reserve(valueCount);
+        for (int j = 0; j < valueCount; j++)
         {
-            valueBlock.append(line.at(i));
+            valueBlock.append(strings[file.getValue(i, j)]);
         }
-        
         varValues.append(valueBlock);
     }
-    varFile.close();
-    // End loading variables
     
-    // Start loading rules
-    rulFilePath = projFolder + projFileStream.readLine();
-    projFile.close();
-    
-    QFile rulFile(rulFilePath);
-    rulFile.open(QFile::ReadOnly);
-    
-    QTextStream rulFileStream(&rulFile);
-    
-    while (!rulFileStream.atEnd())
+    int ruleCount = file.getRuleCount();
+    rules.reserve(ruleCount);
+    for (int i = 0; i < ruleCount; i++)
     {
         Rule r;
-        QStringList line = rulFileStream.readLine().split("-");
-        
-        QStringList ifPart = line.at(0).split("&");
-        for (int i = 0; i < ifPart.length(); i++)
+        int ifCount = file.getIfPairCount(i);
+        int pairCount = file.getPairCount(i);
+        r.ifBlock.reserve(ifCount);
+        r.thenBlock.reserve(pairCount - ifCount);
+        for (int j = 0; j < pairCount; j++)
         {
-            QStringList pair = ifPart.at(i).split("=");
-            if (pair.length() < 2) continue;
-            Pair p{pair.at(0), pair.at(1)};
-            r.ifBlock.append(p);
+            Pair p{strings[file.getPairVar(i, j)], strings[file.getPairValue(i, j)]};
+            if (j < ifCount) r.ifBlock.append(p);
+            else r.thenBlock.append(p);
         }
-        
-        QStringList thenPart = line.at(1).split("&");
-        for (int i = 0; i < thenPart.length(); i++)
-        {
-            QStringList pair = thenPart.at(i).split("=");
-            if (pair.length() < 2) continue;
-            Pair p{pair.at(0), pair.at(1)};
-            r.thenBlock.append(p);
-        }
-        
         rules.append(r);
     }
-    rulFile.close();
-    // End loading rules
     
-    saved = true;
+    return true;
 }
 
 // Constructor for New Project; we pass path to desired project folder
 Project::Project(const QString &folderPath, const QString &projName)
-    : projName(projName), regexpIdentifier("[_a-zA-Z][_a-zA-Z0-9]*")
+    : projName(projName), regexpIdentifier("[_a-zA-Z][_a-zA-Z0-9]*"), format(ProjectFormat::Text), loadError(ErrorCode::NoErrors),
+      nextRuleKey(1), revision(0), baseRevision(0), replaying(false), savedRevision(0)
 {
     QString newProjFolderPath = folderPath + "/" + projName;
     QDir().mkpath(newProjFolderPath);
@@ -209,14 +309,278 @@ Project::Project(const QString &folderPath, const QString &projName)
     
     rulFile.close();
     
-    saved = true;
+    // A Journal left from a Project of the same name in this folder holds edits of that Project
+    QFile::remove(journalFilePath());
+    openJournal();
+    
+    savedRevision = revision;
+}
+
+void Project::buildIndices()
+{
+    varIndex = indexList(varNames);
+    valueIndex.clear();
+    valueIndex.reserve(varValues.length());
+    for (const QStringList &values : varValues)
+    {
+        valueIndex.append(indexList(values));
+    }
+    
+    ruleKeys.clear();
+    ruleIndex.clear();
+    ruleKeys.reserve(rules.length());
+    ruleIndex.reserve(rules.length());
+    for (int i = 0; i < rules.length(); i++)
+    {
+        ruleKeys.append(nextRuleKey);
+        ruleIndex.insert(nextRuleKey++, i);
+    }
+    
+    varRefs.clear();
+    valueRefs.clear();
+    for (int i = 0; i < rules.length(); i++)
+    {
+        addRefs(ruleKeys.at(i), rules.at(i));
+    }
+}
+
+void Project::addRefs(quint64 ruleKey, const Rule &rule)
+{
+    for (const Pair &ifPair : rule.ifBlock)
+    {
+        addRef(ruleKey, ifPair);
+    }
+    for (const Pair &thenPair : rule.thenBlock)
+    {
+        addRef(ruleKey, thenPair);
+    }
 }
 
-void Project::saveProject() const
+void Project::removeRefs(quint64 ruleKey, const Rule &rule)
+{
+    for (const Pair &ifPair : rule.ifBlock)
+    {
+        removeRef(ruleKey, ifPair);
+    }
+    for (const Pair &thenPair : rule.thenBlock)
+    {
+        removeRef(ruleKey, thenPair);
+    }
+}
+
+void Project::addRef(quint64 ruleKey, const Pair &pair)
+{
+    varRefs[pair.var][ruleKey]++;
+    valueRefs[qMakePair(pair.var, pair.value)][ruleKey]++;
+}
+
+void Project::removeRef(quint64 ruleKey, const Pair &pair)
+{
+    unref(&varRefs, pair.var, ruleKey);
+    unref(&valueRefs, qMakePair(pair.var, pair.value), ruleKey);
+}
+
+void Project::cascade(const QString &var, const QString &value, const QString &newVar, const QString &newValue)
+{
+    // A copy, since the edits below change the references
+    QList<quint64> keys = (value.isNull() ? getVarRules(var) : getValueRules(var, value));
+    bool remove = (newVar.isNull() && newValue.isNull());
+    auto matches = [&](const Pair &pair) { return (pair.var == var && (value.isNull() || pair.value == value)); };
+    
+    // Without the IF-Pair the Rule would fire where it never did, so it goes as a whole
+    QSet<int> removedRules;
+    for (quint64 ruleKey : keys)
+    {
+        int ruleId = ruleIndex.value(ruleKey);
+        Rule &rule = rules[ruleId];
+        if (remove && std::any_of(rule.ifBlock.begin(), rule.ifBlock.end(), matches))
+        {
+            removedRules.insert(ruleId);
+            continue;
+        }
+        
+        for (QList<Pair> *block : {&rule.ifBlock, &rule.thenBlock})
+        {
+            for (int i = block->length() - 1; i >= 0; i--)
+            {
+                Pair pair = block->at(i);
+                if (!matches(pair)) continue;
+                
+                removeRef(ruleKey, pair);
+                if (remove)
+                {
+                    block->removeAt(i);
+                    continue;
+                }
+                if (!newVar.isNull()) pair.var = newVar;
+                if (!newValue.isNull()) pair.value = newValue;
+                (*block)[i] = pair;
+                addRef(ruleKey, pair);
+            }
+        }
+    }
+    removeRules(removedRules);
+}
+
+void Project::removeRules(const QSet<int> &ruleIds)
+{
+    if (ruleIds.isEmpty()) return;
+    
+    // Kept Rules after the first removed one move up
+    int first = *std::min_element(ruleIds.begin(), ruleIds.end());
+    int next = first;
+    for (int i = first; i < rules.length(); i++)
+    {
+        quint64 ruleKey = ruleKeys.at(i);
+        if (ruleIds.contains(i))
+        {
+            removeRefs(ruleKey, rules.at(i));
+            ruleIndex.remove(ruleKey);
+            continue;
+        }
+        
+        rules[next] = rules.at(i);
+        ruleKeys[next] = ruleKey;
+        ruleIndex[ruleKey] = next;
+        next++;
+    }
+    rules.erase(rules.begin() + next, rules.end());
+    ruleKeys.erase(ruleKeys.begin() + next, ruleKeys.end());
+}
+
+Error Project::saveProject()
+{
+    // Without Journal every save rewrites the Project Files
+    if (commitJournal()) return Error(ErrorCode::NoErrors);
+    return compact();
+}
+
+Error Project::compact()
+{
+    if (revision != baseRevision)
+    {
+        if (Error err = snapshot().write()) return err;
+    }
+    
+    setSnapshotSaved(revision);
+    return Error(ErrorCode::NoErrors);
+}
+
+bool Project::commitJournal()
+{
+    if (!journal) return false;
+    if (journal->commit(revision))
+    {
+        savedRevision = revision;
+        return true;
+    }
+    journal.reset();
+    return false;
+}
+
+bool Project::needsCompaction() const
+{
+    return (!journal || journal->getSize() > maxJournalSize);
+}
+
+ProjectSnapshot Project::snapshot() const
+{
+    ProjectSnapshot s;
+    s.projName = projName;
+    s.projFilePath = projFilePath;
+    s.varFilePath = varFilePath;
+    s.rulFilePath = rulFilePath;
+    // Edited data goes to new Files, so the old ".esp" keeps pointing at Files that match its revision
+    if (format == ProjectFormat::Text && revision != baseRevision)
+    {
+        s.varFilePath = generationFilePath(".var", revision);
+        s.rulFilePath = generationFilePath(".rul", revision);
+        s.oldVarFilePath = varFilePath;
+        s.oldRulFilePath = rulFilePath;
+    }
+    s.format = format;
+    s.varNames = varNames;
+    s.varValues = varValues;
+    s.rules = rules;
+    s.revision = revision;
+    return s;
+}
+
+void Project::setSnapshotSaved(quint64 snapshotRevision)
+{
+    // The ".esp" points at the Files written by "snapshot()" now
+    if (format == ProjectFormat::Text && snapshotRevision > baseRevision)
+    {
+        varFilePath = generationFilePath(".var", snapshotRevision);
+        rulFilePath = generationFilePath(".rul", snapshotRevision);
+    }
+    
+    baseRevision = qMax(baseRevision, snapshotRevision);
+    savedRevision = qMax(savedRevision, snapshotRevision);
+    
+    // Records up to "baseRevision" would be skipped anyway; later ones are still needed
+    if (snapshotRevision == revision && journal && !journal->clear()) journal.reset();
+}
+
+Error Project::exportProject(const QString &filePath, ProjectFormat format) const
+{
+    QFileInfo info(filePath);
+    QString baseName = info.completeBaseName();
+    QString folder = info.absolutePath() + "/";
+    
+    // Text format puts ".var" and ".rul" next to the ".esp"
+    ProjectSnapshot s = snapshot();
+    s.projFilePath = filePath;
+    s.varFilePath = folder + baseName + ".var";
+    s.rulFilePath = folder + baseName + ".rul";
+    s.oldVarFilePath.clear();
+    s.oldRulFilePath.clear();
+    s.format = format;
+    return s.write();
+}
+
+ProjectSnapshot::ProjectSnapshot()
+    : format(ProjectFormat::Text), revision(0)
+{
+    
+}
+
+Error ProjectSnapshot::write() const
+{
+    bool ok;
+    if (format == ProjectFormat::Binary) ok = BinaryProjectFile::write(projFilePath, projName, varNames, varValues, rules, revision);
+    else ok = saveText() && saveProjFile();
+    if (!ok) return Error(ErrorCode::FileError);
+    
+    // Nothing points at the replaced Files any more
+    for (const QString &oldFilePath : {oldVarFilePath, oldRulFilePath})
+    {
+        if (!oldFilePath.isEmpty() && oldFilePath != varFilePath && oldFilePath != rulFilePath) QFile::remove(oldFilePath);
+    }
+    return Error(ErrorCode::NoErrors);
+}
+
+bool ProjectSnapshot::saveProjFile() const
+{
+    // Project Name, ".var" and ".rul" File Names, revision
+    QSaveFile projFile(projFilePath);
+    if (!projFile.open(QSaveFile::WriteOnly | QSaveFile::Truncate)) return false;
+    QTextStream projFileStream(&projFile);
+    
+    projFileStream << projName + "\n";
+    projFileStream << QFileInfo(varFilePath).fileName() + "\n";
+    projFileStream << QFileInfo(rulFilePath).fileName() + "\n";
+    projFileStream << QString::number(revision) + "\n";
+    
+    projFileStream.flush();
+    return projFile.commit();
+}
+
+bool ProjectSnapshot::saveText() const
 {
     // Start saving variables
     QSaveFile varFile(varFilePath);
-    varFile.open(QSaveFile::WriteOnly | QSaveFile::Truncate);
+    if (!varFile.open(QSaveFile::WriteOnly | QSaveFile::Truncate)) return false;
     QTextStream varFileStream(&varFile);
     
     for (int i = 0; i < varNames.length(); i++)
@@ -228,12 +592,13 @@ void Project::saveProject() const
         }
         varFileStream << "\n";
     }
-    varFile.commit();
+    varFileStream.flush();
+    if (!varFile.commit()) return false;
     // End saving variables
     
     // Start saving rules
     QSaveFile rulFile(rulFilePath);
-    rulFile.open(QSaveFile::WriteOnly | QSaveFile::Truncate);
+    if (!rulFile.open(QSaveFile::WriteOnly | QSaveFile::Truncate)) return false;
     QTextStream rulFileStream(&rulFile);
     
     int last;
@@ -264,10 +629,108 @@ void Project::saveProject() const
         rulFileStream << "\n";
         
     }
-    rulFile.commit();
+    rulFileStream.flush();
+    if (!rulFile.commit()) return false;
     // End saving rules
     
-    saved = true;
+    return true;
+}
+
+QString Project::generationFilePath(const QString &extension, quint64 fileRevision) const
+{
+    QFileInfo info(projFilePath);
+    return info.absolutePath() + "/" + info.completeBaseName() + "." + QString::number(fileRevision) + extension;
+}
+
+QString Project::journalFilePath() const
+{
+    QFileInfo info(projFilePath);
+    return info.absolutePath() + "/" + info.completeBaseName() + ".journal";
+}
+
+void Project::openJournal()
+{
+    journal.reset(new ProjectJournal(journalFilePath()));
+    
+    QList<ProjectJournal::Record> committed;
+    bool writable = journal->open(&committed);
+    
+    // Edits saved after the Project Files were written
+    replaying = true;
+    for (const ProjectJournal::Record &r : committed)
+    {
+        if (r.revision <= baseRevision) continue;
+        replay(r);
+        revision = r.revision;
+    }
+    replaying = false;
+    
+    if (!writable) journal.reset();
+}
+
+void Project::record(ProjectJournal::Operation operation, const QVector<qint32> &numbers, const QStringList &strings)
+{
+    revision++;
+    if (!journal || replaying) return;
+    
+    ProjectJournal::Record r{revision, operation, numbers, strings};
+    if (!journal->append(r)) journal.reset();
+}
+
+void Project::replay(const ProjectJournal::Record &r)
+{
+    const QVector<qint32> &n = r.numbers;
+    const QStringList &s = r.strings;
+    
+    switch (r.operation) {
+    case ProjectJournal::Operation::AddVar:
+        addVar(s.value(0), s.mid(1));
+        break;
+    case ProjectJournal::Operation::AddVarValue:
+        addVarValue(s.value(0), n.value(0));
+        break;
+    case ProjectJournal::Operation::DeleteVar:
+        deleteVar(n.value(0));
+        break;
+    case ProjectJournal::Operation::DeleteVarValue:
+        deleteVarValue(n.value(0), n.value(1));
+        break;
+    case ProjectJournal::Operation::SetVarName:
+        setVarName(s.value(0), n.value(0));
+        break;
+    case ProjectJournal::Operation::SetVarValue:
+        setVarValue(s.value(0), n.value(0), n.value(1));
+        break;
+    case ProjectJournal::Operation::AddRule:
+    {
+        // "numbers" holds the count of IF-Pairs, "strings" all Pairs as Variable, Value
+        Rule rule;
+        for (int i = 0; i + 1 < s.length(); i += 2)
+        {
+            if (i / 2 < n.value(0)) rule.ifBlock.append(Pair(s.at(i), s.at(i + 1)));
+            else rule.thenBlock.append(Pair(s.at(i), s.at(i + 1)));
+        }
+        addRule(rule);
+        break;
+    }
+    case ProjectJournal::Operation::AddIfPair:
+        addIfPair(Pair(s.value(0), s.value(1)), n.value(0));
+        break;
+    case ProjectJournal::Operation::AddThenPair:
+        addThenPair(Pair(s.value(0), s.value(1)), n.value(0));
+        break;
+    case ProjectJournal::Operation::DeleteRule:
+        deleteRule(n.value(0));
+        break;
+    case ProjectJournal::Operation::DeleteIfPair:
+        deleteIfPair(n.value(0), n.value(1));
+        break;
+    case ProjectJournal::Operation::DeleteThenPair:
+        deleteThenPair(n.value(0), n.value(1));
+        break;
+    case ProjectJournal::Operation::Commit:
+        break;
+    }
 }
 
 const QString &Project::getProjName() const
@@ -275,6 +738,16 @@ const QString &Project::getProjName() const
     return projName;
 }
 
+ProjectFormat Project::getFormat() const
+{
+    return format;
+}
+
+const Error &Project::getLoadError() const
+{
+    return loadError;
+}
+
 const QStringList &Project::getVarNames() const
 {
     return varNames;
@@ -299,6 +772,28 @@ const QStringList *Project::getVarValues(const QString &varName) const
     return getVarValues(varId);
 }
 
+QList<quint64> Project::getVarRules(const QString &varName) const
+{
+    return varRefs.value(varName).keys();
+}
+
+QList<quint64> Project::getValueRules(const QString &varName, const QString &valueName) const
+{
+    return valueRefs.value(qMakePair(varName, valueName)).keys();
+}
+
+int Project::getVarRuleCount(const QString &varName) const
+{
+    QHash<QString, QHash<quint64, int>>::const_iterator it = varRefs.find(varName);
+    return (it == varRefs.end() ? 0 : it.value().size());
+}
+
+int Project::getValueRuleCount(const QString &varName, const QString &valueName) const
+{
+    QHash<QPair<QString, QString>, QHash<quint64, int>>::const_iterator it = valueRefs.find(qMakePair(varName, valueName));
+    return (it == valueRefs.end() ? 0 : it.value().size());
+}
+
 const QList<Rule> &Project::getRules() const
 {
     return rules;
@@ -311,13 +806,25 @@ const Rule *Project::getRule(int ruleId) const
     return (&rules.at(ruleId));
 }
 
-const Rule *Project::getRule(const QString &ruleStringified) const
+const Rule *Project::getRuleByKey(quint64 ruleKey) const
 {
-    int ruleId = ruleStringified.section(')', 0, 0).toInt() - 1;
-    if (!ruleExists(ruleId)) return nullptr;
+    int ruleId = getRuleId(ruleKey);
+    if (ruleId == -1) return nullptr;
     return getRule(ruleId);
 }
 
+quint64 Project::getRuleKey(int ruleId) const
+{
+    normalizeRuleId(&ruleId);
+    if (!ruleExists(ruleId)) return 0;
+    return ruleKeys.at(ruleId);
+}
+
+int Project::getRuleId(quint64 ruleKey) const
+{
+    return ruleIndex.value(ruleKey, -1);
+}
+
 QStringList Project::getRulezzStringified() const
 {
     QStringList result;
@@ -336,16 +843,16 @@ QString Project::getRuleStringified(int ruleId) const
     return QString(zeros(ruleId + 1, rules.length()) + QString::number(ruleId + 1) + ") " + rules.at(ruleId).stringify());
 }
 
-QString Project::getRuleStringified(const QString &ruleStringified) const
+QString Project::getRuleStringifiedByKey(quint64 ruleKey) const
 {
-    int ruleId = ruleStringified.section(')', 0, 0).toInt() - 1;
-    if (!ruleExists(ruleId)) return QString();
+    int ruleId = getRuleId(ruleKey);
+    if (ruleId == -1) return QString();
     return getRuleStringified(ruleId);
 }
 
 bool Project::isSaved() const
 {
-    return saved;
+    return (savedRevision == revision);
 }
 
 Error Project::addVar(const QString &varName, const QStringList &values)
@@ -357,9 +864,11 @@ Error Project::addVar(const QString &varName, const QStringList &values)
     {
         if (!isValid(s)) return Error(ErrorCode::InvalidIdentifier);
     }
+    varIndex.insert(varName, varNames.length());
     varNames.append(varName);
     varValues.append(values);
-    saved = false;
+    valueIndex.append(indexList(values));
+    record(ProjectJournal::Operation::AddVar, QVector<qint32>(), QStringList(varName) + values);
     return Error(ErrorCode::NoErrors);
 }
 
@@ -370,8 +879,9 @@ Error Project::addVarValue(const QString &newValue, int varId)
     if (!isValid(newValue)) return Error(ErrorCode::InvalidIdentifier);
     if (valueExists(varId, newValue)) return Error(ErrorCode::IdentifierAlreadyExists);
     
+    valueIndex[varId].insert(newValue, varValues.at(varId).length());
     varValues[varId].append(newValue);
-    saved = false;
+    record(ProjectJournal::Operation::AddVarValue, {varId}, QStringList(newValue));
     return Error(ErrorCode::NoErrors);
 }
 
@@ -387,9 +897,12 @@ Error Project::deleteVar(int varId)
     normalizeVarId(&varId);
     if (!varExists(varId)) return Error(ErrorCode::UnknownVariableId);
     
-    varNames.removeAt(varId);
+    QString varName = varNames.takeAt(varId);
     varValues.removeAt(varId);
-    saved = false;
+    valueIndex.removeAt(varId);
+    removeFromIndex(&varIndex, varNames, varId, varName);
+    cascade(varName, QString(), QString(), QString());
+    record(ProjectJournal::Operation::DeleteVar, {varId});
     return Error(ErrorCode::NoErrors);
 }
 
@@ -407,8 +920,10 @@ Error Project::deleteVarValue(int varId, int valueId)
     normalizeValueId(varId, &valueId);
     if (!valueExists(varId, valueId)) return Error(ErrorCode::UnknownValueId);
     
-    varValues[varId].removeAt(valueId);
-    saved = false;
+    QString valueName = varValues[varId].takeAt(valueId);
+    removeFromIndex(&valueIndex[varId], varValues.at(varId), valueId, valueName);
+    cascade(varNames.at(varId), valueName, QString(), QString());
+    record(ProjectJournal::Operation::DeleteVarValue, {varId, valueId});
     return Error(ErrorCode::NoErrors);
 }
 
@@ -429,8 +944,11 @@ Error Project::setVarName(const QString &newName, int varId)
     if (!isValid(newName)) return Error(ErrorCode::InvalidIdentifier);
     if (varExists(newName)) return Error(ErrorCode::IdentifierAlreadyExists);
     
+    QString oldName = varNames.at(varId);
     varNames[varId] = newName;
-    saved = false;
+    renameInIndex(&varIndex, varNames, varId, oldName);
+    cascade(oldName, QString(), newName, QString());
+    record(ProjectJournal::Operation::SetVarName, {varId}, QStringList(newName));
     return Error(ErrorCode::NoErrors);
 }
 
@@ -450,8 +968,11 @@ Error Project::setVarValue(const QString &newValue, int varId, int valueId)
     if (!isValid(newValue)) return Error(ErrorCode::InvalidIdentifier);
     if (valueExists(varId, newValue)) return Error(ErrorCode::IdentifierAlreadyExists);
     
+    QString oldValue = varValues.at(varId).at(valueId);
     varValues[varId][valueId] = newValue;
-    saved = false;
+    renameInIndex(&valueIndex[varId], varValues.at(varId), valueId, oldValue);
+    cascade(varNames.at(varId), oldValue, QString(), newValue);
+    record(ProjectJournal::Operation::SetVarValue, {varId, valueId}, QStringList(newValue));
     return Error(ErrorCode::NoErrors);
 }
 
@@ -467,8 +988,20 @@ Error Project::setVarValue(const QString &newValue, const QString &varName, cons
 
 Error Project::addRule(const Rule &rule)
 {
+    addRefs(nextRuleKey, rule);
+    ruleIndex.insert(nextRuleKey, rules.length());
+    ruleKeys.append(nextRuleKey++);
     rules.append(rule);
-    saved = false;
+    QStringList pairs;
+    for (const Pair &ifPair : rule.ifBlock)
+    {
+        pairs << ifPair.var << ifPair.value;
+    }
+    for (const Pair &thenPair : rule.thenBlock)
+    {
+        pairs << thenPair.var << thenPair.value;
+    }
+    record(ProjectJournal::Operation::AddRule, {rule.ifBlock.length()}, pairs);
     return Error(ErrorCode::NoErrors);
 }
 
@@ -476,17 +1009,18 @@ Error Project::addIfPair(const Pair &ifPair, int ruleId)
 {
     normalizeRuleId(&ruleId);
     if (!ruleExists(ruleId)) return Error(ErrorCode::UnknownRuleId);
-    if (ifPairExists(ruleId, ifPair)) Error(ErrorCode::PairAlreadyExists);
+    if (ifPairExists(ruleId, ifPair)) return Error(ErrorCode::PairAlreadyExists);
     
     rules[ruleId].ifBlock.append(ifPair);
-    saved = false;
+    addRef(ruleKeys.at(ruleId), ifPair);
+    record(ProjectJournal::Operation::AddIfPair, {ruleId}, QStringList{ifPair.var, ifPair.value});
     return Error(ErrorCode::NoErrors);
 }
 
-Error Project::addIfPair(const Pair &ifPair, const QString &ruleStringified)
+Error Project::addIfPairByKey(const Pair &ifPair, quint64 ruleKey)
 {
-    int ruleId = ruleStringified.section(')', 0, 0).toInt() - 1;
-    if (!ruleExists(ruleId)) return Error(ErrorCode::UnknownRuleId);
+    int ruleId = getRuleId(ruleKey);
+    if (ruleId == -1) return Error(ErrorCode::UnknownRuleId);
     return addIfPair(ifPair, ruleId);
 }
 
@@ -494,17 +1028,18 @@ Error Project::addThenPair(const Pair &thenPair, int ruleId)
 {
     normalizeRuleId(&ruleId);
     if (!ruleExists(ruleId)) return Error(ErrorCode::UnknownRuleId);
-    if (thenPairExists(ruleId, thenPair)) Error(ErrorCode::PairAlreadyExists);
+    if (thenPairExists(ruleId, thenPair)) return Error(ErrorCode::PairAlreadyExists);
     
     rules[ruleId].thenBlock.append(thenPair);
-    saved = false;
+    addRef(ruleKeys.at(ruleId), thenPair);
+    record(ProjectJournal::Operation::AddThenPair, {ruleId}, QStringList{thenPair.var, thenPair.value});
     return Error(ErrorCode::NoErrors);
 }
 
-Error Project::addThenPair(const Pair &thenPair, const QString &ruleStringified)
+Error Project::addThenPairByKey(const Pair &thenPair, quint64 ruleKey)
 {
-    int ruleId = ruleStringified.section(')', 0, 0).toInt() - 1;
-    if (!ruleExists(ruleId)) return Error(ErrorCode::UnknownRuleId);
+    int ruleId = getRuleId(ruleKey);
+    if (ruleId == -1) return Error(ErrorCode::UnknownRuleId);
     return addThenPair(thenPair, ruleId);
 }
 
@@ -513,15 +1048,15 @@ Error Project::deleteRule(int ruleId)
     normalizeRuleId(&ruleId);
     if (!ruleExists(ruleId)) return Error(ErrorCode::UnknownRuleId);
     
-    rules.removeAt(ruleId);
-    saved = false;
+    removeRules({ruleId});
+    record(ProjectJournal::Operation::DeleteRule, {ruleId});
     return Error(ErrorCode::NoErrors);
 }
 
-Error Project::deleteRule(const QString &ruleStringified)
+Error Project::deleteRuleByKey(quint64 ruleKey)
 {
-    int ruleId = ruleStringified.section(')', 0, 0).toInt() - 1;
-    if (!ruleExists(ruleId)) return Error(ErrorCode::UnknownRuleId);
+    int ruleId = getRuleId(ruleKey);
+    if (ruleId == -1) return Error(ErrorCode::UnknownRuleId);
     return deleteRule(ruleId);
 }
 
@@ -532,15 +1067,16 @@ Error Project::deleteIfPair(int ruleId, int ifPairId)
     normalizeIfPairId(ruleId, &ifPairId);
     if (!ifPairExists(ruleId, ifPairId)) return Error(ErrorCode::UnknownPairId);
     
+    removeRef(ruleKeys.at(ruleId), rules.at(ruleId).ifBlock.at(ifPairId));
     rules[ruleId].ifBlock.removeAt(ifPairId);
-    saved = false;
+    record(ProjectJournal::Operation::DeleteIfPair, {ruleId, ifPairId});
     return Error(ErrorCode::NoErrors);
 }
 
-Error Project::deleteIfPair(const QString &ruleStringified, int ifPairId)
+Error Project::deleteIfPairByKey(quint64 ruleKey, int ifPairId)
 {
-    int ruleId = ruleStringified.section(')', 0, 0).toInt() - 1;
-    if (!ruleExists(ruleId)) return Error(ErrorCode::UnknownRuleId);
+    int ruleId = getRuleId(ruleKey);
+    if (ruleId == -1) return Error(ErrorCode::UnknownRuleId);
     return deleteIfPair(ruleId, ifPairId);
 }
 
@@ -551,14 +1087,15 @@ Error Project::deleteThenPair(int ruleId, int thenPairId)
     normalizeThenPairId(ruleId, &thenPairId);
     if (!thenPairExists(ruleId, thenPairId)) return Error(ErrorCode::UnknownPairId);
     
+    removeRef(ruleKeys.at(ruleId), rules.at(ruleId).thenBlock.at(thenPairId));
     rules[ruleId].thenBlock.removeAt(thenPairId);
-    saved = false;
+    record(ProjectJournal::Operation::DeleteThenPair, {ruleId, thenPairId});
     return Error(ErrorCode::NoErrors);
 }
 
-Error Project::deleteThenPair(const QString &ruleStringified, int thenPairId)
+Error Project::deleteThenPairByKey(quint64 ruleKey, int thenPairId)
 {
-    int ruleId = ruleStringified.section(')', 0, 0).toInt() - 1;
-    if (!ruleExists(ruleId)) return Error(ErrorCode::UnknownRuleId);
+    int ruleId = getRuleId(ruleKey);
+    if (ruleId == -1) return Error(ErrorCode::UnknownRuleId);
     return deleteThenPair(ruleId, thenPairId);
 }
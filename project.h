@@ -1,9 +1,14 @@
 #ifndef PROJECT_H
 #define PROJECT_H
 
+#include "projectjournal.h"
+
 #include <memory>
 #include <QString>
 #include <QList>
+#include <QHash>
+#include <QSet>
+#include <QPair>
 #include <QStringList>
 #include <QRegExp>
 #include <QCoreApplication>
@@ -22,13 +27,17 @@ enum class ErrorCode : int
     UnknownValueName,
     UnknownRuleId,
     UnknownPairId,
-    PairAlreadyExists
+    PairAlreadyExists,
+    FileError,
+    ParseError
 };
 
 struct Error
 {
 public:
     Error(ErrorCode errCode);
+    // "details" are appended to the message on separate lines
+    Error(ErrorCode errCode, const QString &details);
     
     inline QString text() const
     {
@@ -40,6 +49,8 @@ public:
         return (errCode != ErrorCode::NoErrors);
     }
     
+    inline ErrorCode getCode() const { return errCode; }
+    
 private:
     ErrorCode errCode;
     QString message;
@@ -79,22 +90,92 @@ struct Rule
     QList<Pair> thenBlock;
 };
 
+enum class ProjectFormat : int
+{
+    // ".esp" File with Variables and Rules in ".var" and ".rul" text Files next to it
+    Text = 0,
+    // Single ".esb" File, see "binaryprojectfile.h"
+    Binary
+};
+
+// Copy of the Project data taken by "Project::snapshot()". The Lists are shared with the Project
+// until it is edited, so taking it is cheap and it can be written on another thread
+class ProjectSnapshot
+{
+public:
+    ProjectSnapshot();
+    
+    // Writes Project Files in "format": ".esb" at "projFilePath", or ".esp" there with ".var" and ".rul" at their paths.
+    // ".esp" is written last and replaced in one step, so it only points past the Journal once ".var" and ".rul"
+    // are complete; the old ".var" and ".rul" are removed afterwards
+    Error write() const;
+    
+    inline quint64 getRevision() const { return revision; }
+    
+private:
+    bool saveText() const;
+    bool saveProjFile() const;
+    
+private:
+    friend class Project;
+    
+    QString projName;
+    QString projFilePath;
+    QString varFilePath;
+    QString rulFilePath;
+    // Files the ".esp" pointed at before; empty if they stay
+    QString oldVarFilePath;
+    QString oldRulFilePath;
+    ProjectFormat format;
+    
+    QStringList varNames;
+    QList<QStringList> varValues;
+    QList<Rule> rules;
+    
+    quint64 revision;
+    
+};
+
 class Project
 {
 public:
-    // Constructor for Existing Project; we pass path to ".esp" file
+    // Constructor for Existing Project; we pass path to ".esp" or ".esb" file, the format is detected from its contents
     Project(const QString &projFilePath);
     // Constructor for New Project; we pass path to desired project folder
     Project(const QString &newProjFolderPath, const QString &projName);
     
+    // Copies would share the Journal and write edits of each other into it
+    Project(const Project &) = delete;
+    Project &operator=(const Project &) = delete;
+    
     
-    // Saves Project to its Files
-    void saveProject() const;
+    // Saves Project: commits the edits in its Journal ("<project>.journal"), or rewrites its Files if there is no Journal
+    Error saveProject();
+    // Rewrites Project Files in their format with all edits and empties the Journal; the Project is saved afterwards
+    Error compact();
+    
+    // Asynchronous saving, see "ProjectSaver":
+    // Commits the Journal; returns "false" if there is no Journal and the Project Files have to be rewritten
+    bool commitJournal();
+    // "true" if there is no Journal or it has grown past "maxJournalSize"
+    bool needsCompaction() const;
+    ProjectSnapshot snapshot() const;
+    // Called once a snapshot is in the Project Files; the Project is saved if it was not edited since
+    void setSnapshotSaved(quint64 snapshotRevision);
+    
+    static const qint64 maxJournalSize = 16 << 20;
+    // Writes a copy of the Project in the given format; "filePath" is the ".esp" or ".esb" file to create.
+    // Text format puts ".var" and ".rul" files next to it. The Project keeps its own Files
+    Error exportProject(const QString &filePath, ProjectFormat format) const;
     
     
     // Getters
     
     const QString &getProjName() const;
+    ProjectFormat getFormat() const;
+    // Error of the Constructor for Existing Project: "FileError" if the Files could not be read,
+    // "ParseError" if some malformed lines were skipped
+    const Error &getLoadError() const;
     const QStringList &getVarNames() const;
     const QList<QStringList> &getAllVarValues() const;
     
@@ -104,16 +185,30 @@ public:
     // Returns "nullptr" if some errors occurred
     const QStringList *getVarValues(const QString &varName) const;
     
+    // Keys of the Rules with Pairs of the Variable or of its Value, see "getRuleKey()"
+    QList<quint64> getVarRules(const QString &varName) const;
+    QList<quint64> getValueRules(const QString &varName, const QString &valueName) const;
+    // Number of these Rules
+    int getVarRuleCount(const QString &varName) const;
+    int getValueRuleCount(const QString &varName, const QString &valueName) const;
+    
     const QList<Rule> &getRules() const;
     const Rule *getRule(int ruleId = -1) const;
-    const Rule *getRule(const QString &ruleStringified) const;
+    const Rule *getRuleByKey(quint64 ruleKey) const;
+    
+    // Every Rule gets a key when it is loaded or added. It stays the same while the Project is open,
+    // when other Rules are added or deleted; "0" is never a key. Functions taking a key end in "ByKey"
+    // "-1" means last added Rule; returns "0" if there is no such Rule
+    quint64 getRuleKey(int ruleId = -1) const;
+    // Position of the Rule in "getRules()"; "-1" if there is no such Rule
+    int getRuleId(quint64 ruleKey) const;
     
     // Returns all Rules Stringified
     QStringList getRulezzStringified() const;
     // "-1" means last added Rule
     QString getRuleStringified(int ruleId = -1) const;
     // Used to get rule representation after changes
-    QString getRuleStringified(const QString &ruleStringified) const;
+    QString getRuleStringifiedByKey(quint64 ruleKey) const;
     
     bool isSaved() const;
     
@@ -121,6 +216,8 @@ public:
     // Setters
     
     // Variables
+    // Renaming a Variable or Value renames its Pairs in all Rules. Deleting one deletes its THEN-Pairs
+    // and the Rules with its IF-Pairs, since those can never fire any more
     
     Error addVar(const QString &varName, const QStringList &values);
     // "-1" means last added Variable Name
@@ -147,41 +244,68 @@ public:
     Error addRule(const Rule &rule);
     // "-1" means last added Rule
     Error addIfPair(const Pair &ifPair, int ruleId = -1);
-    Error addIfPair(const Pair &ifPair, const QString &ruleStringified);
+    Error addIfPairByKey(const Pair &ifPair, quint64 ruleKey);
     // "-1" means last added Rule
     Error addThenPair(const Pair &thenPair, int ruleId = -1);
-    Error addThenPair(const Pair &thenPair, const QString &ruleStringified);
+    Error addThenPairByKey(const Pair &thenPair, quint64 ruleKey);
     
     // "-1" means last added Rule
     Error deleteRule(int ruleId = -1);
-    Error deleteRule(const QString &ruleStringified);
+    Error deleteRuleByKey(quint64 ruleKey);
     // "-1" means last added Rule and Pair respectively
     Error deleteIfPair(int ruleId = -1, int ifPairId = -1);
     // "-1" means last added Pair respectively
-    Error deleteIfPair(const QString &ruleStringified, int ifPairId = -1);
+    Error deleteIfPairByKey(quint64 ruleKey, int ifPairId = -1);
     // "-1" means last added Rule and Pair respectively
     Error deleteThenPair(int ruleId = -1, int thenPairId = -1);
     // "-1" means last added Pair respectively
-    Error deleteThenPair(const QString &ruleStringified, int thenPairId = -1);
+    Error deleteThenPairByKey(quint64 ruleKey, int thenPairId = -1);
     
     
 private:
+    bool loadText();
+    bool loadBinary();
+    // "<project>.<revision><extension>" next to the Project File; Text format writes edited ".var" and ".rul" there
+    QString generationFilePath(const QString &extension, quint64 fileRevision) const;
+    // "<project>.journal" next to the Project File
+    QString journalFilePath() const;
+    // Opens the Journal and applies its committed Records newer than the Project Files
+    void openJournal();
+    // Called by every successful edit with its normalized arguments
+    void record(ProjectJournal::Operation operation, const QVector<qint32> &numbers, const QStringList &strings = QStringList());
+    void replay(const ProjectJournal::Record &r);
+    
+    // Builds "varIndex" and "valueIndex" from loaded Lists, gives keys to loaded Rules and fills "varRefs" and "valueRefs"
+    void buildIndices();
+    
+    void addRefs(quint64 ruleKey, const Rule &rule);
+    void removeRefs(quint64 ruleKey, const Rule &rule);
+    void addRef(quint64 ruleKey, const Pair &pair);
+    void removeRef(quint64 ruleKey, const Pair &pair);
+    // Edits Pairs of Variable "var" (and Value "value" if it is not null) in the Rules referring to it:
+    // sets their Variable to "newVar" and Value to "newValue" where those are not null. If both are null,
+    // removes the THEN-Pairs and the Rules with such IF-Pairs
+    void cascade(const QString &var, const QString &value, const QString &newVar, const QString &newValue);
+    // Removes the Rules in one pass over the List, without Journal Records
+    void removeRules(const QSet<int> &ruleIds);
+    
     inline bool isValid(const QString &name) const { return regexpIdentifier.exactMatch(name); }
     
-    inline int getVarId(const QString &varName) const { return varNames.indexOf(varName); }
-    inline int getValueId(int varId, const QString &valueName) const { return varValues.at(varId).indexOf(valueName); }
+    inline int getVarId(const QString &varName) const { return varIndex.value(varName, -1); }
+    inline int getValueId(int varId, const QString &valueName) const { return valueIndex.at(varId).value(valueName, -1); }
     
     inline bool varExists(int varId) const { return (varId < varNames.length() && varId >= 0); }    
-    inline bool varExists(const QString &varName) const { return varNames.contains(varName); }
+    inline bool varExists(const QString &varName) const { return varIndex.contains(varName); }
     
     inline bool valueExists(int varId, int valueId) const { return (valueId < varValues.at(varId).length() && valueId >= 0); }
-    inline bool valueExists(int varId, const QString &valueName) const { return varValues.at(varId).contains(valueName); }
+    inline bool valueExists(int varId, const QString &valueName) const { return valueIndex.at(varId).contains(valueName); }
     
     inline void normalizeVarId(int *varId) const { if (*varId == -1) *varId = varNames.length() - 1; }
     inline void normalizeValueId(int varId, int *valueId) const { if (*valueId == -1) *valueId = varValues.at(varId).length() - 1; }
     
     inline bool ruleExists(int ruleId) const { return (ruleId < rules.length() && ruleId >= 0); }
 
+    // Pair checks scan one Block of a few Pairs, so they need no index
     inline bool ifPairExists(int ruleId, int ifPairId) const { return (ifPairId < rules.at(ruleId).ifBlock.length() && ifPairId >= 0); }
     inline bool ifPairExists(int ruleId, const Pair &ifPair) const { return rules.at(ruleId).ifBlock.contains(ifPair); }
     
@@ -215,9 +339,33 @@ private:
     QList<QStringList> varValues;
     QList<Rule> rules;
     
+    // Name -> id of its first occurrence in "varNames" and in every List of "varValues"; updated by every edit
+    QHash<QString, int> varIndex;
+    QList<QHash<QString, int>> valueIndex;
+    
+    // Key of every Rule in "rules" and its position there; keys are not saved in Project Files
+    QList<quint64> ruleKeys;
+    QHash<quint64, int> ruleIndex;
+    quint64 nextRuleKey;
+    
+    // Variable Name -> key of every Rule with Pairs of it -> number of these Pairs
+    QHash<QString, QHash<quint64, int>> varRefs;
+    // The same for Variable Name and Value
+    QHash<QPair<QString, QString>, QHash<quint64, int>> valueRefs;
+    
     QRegExp regexpIdentifier;
     
-    mutable bool saved;
+    ProjectFormat format;
+    Error loadError;
+    
+    // Number of edits since the Project was created; Project Files contain all edits up to "baseRevision"
+    quint64 revision;
+    quint64 baseRevision;
+    // "nullptr" if the Journal can not be written
+    std::unique_ptr<ProjectJournal> journal;
+    bool replaying;
+    // Last revision that is in the Project Files or committed to the Journal
+    quint64 savedRevision;
     
 };
 
@@ -0,0 +1,135 @@
+#include "projectjournal.h"
+
+#include <QDataStream>
+#include <QtEndian>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+
+ProjectJournal::ProjectJournal(const QString &filePath) :
+    filePath(filePath),
+    file(filePath)
+{
+    
+}
+
+bool ProjectJournal::open(QList<Record> *committed)
+{
+    // The File is created by the first "append"
+    if (!QFile::exists(filePath)) return true;
+    
+    if (!file.open(QFile::ReadWrite))
+    {
+        // Committed Records are still read, but nothing can be appended
+        if (file.open(QFile::ReadOnly)) readRecords(committed);
+        file.close();
+        return false;
+    }
+    
+    // Unsaved or broken tail would hide the Records appended after it
+    qint64 committedSize = readRecords(committed);
+    if (committedSize != file.size())
+    {
+        if (!file.resize(committedSize)) return false;
+    }
+    return file.seek(committedSize);
+}
+
+bool ProjectJournal::append(const Record &record)
+{
+    if (!file.isOpen() && !file.open(QFile::ReadWrite)) return false;
+    
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << record.revision << static_cast<quint8>(record.operation) << record.numbers << record.strings;
+    
+    uchar header[6];
+    qToLittleEndian<quint32>(static_cast<quint32>(payload.size()), header);
+    qToLittleEndian<quint16>(qChecksum(payload.constData(), static_cast<uint>(payload.size())), header + 4);
+    
+    payload.prepend(reinterpret_cast<const char *>(header), 6);
+    return (file.write(payload) == payload.size());
+}
+
+bool ProjectJournal::commit(quint64 revision)
+{
+    Record record;
+    record.revision = revision;
+    record.operation = Operation::Commit;
+    if (!append(record)) return false;
+    return sync();
+}
+
+bool ProjectJournal::clear()
+{
+    if (!file.isOpen()) return true;
+    if (!file.resize(0) || !file.seek(0)) return false;
+    return sync();
+}
+
+const QString &ProjectJournal::getFilePath() const
+{
+    return filePath;
+}
+
+qint64 ProjectJournal::getSize() const
+{
+    return file.size();
+}
+
+qint64 ProjectJournal::readRecords(QList<Record> *committed)
+{
+    QByteArray bytes = file.readAll();
+    const uchar *data = reinterpret_cast<const uchar *>(bytes.constData());
+    
+    QList<Record> pending;
+    qint64 committedSize = 0;
+    qint64 position = 0;
+    while (bytes.size() - position >= 6)
+    {
+        quint32 length = qFromLittleEndian<quint32>(data + position);
+        quint16 checksum = qFromLittleEndian<quint16>(data + position + 4);
+        if (length > static_cast<quint64>(bytes.size() - position - 6)) break;
+        
+        const char *payload = bytes.constData() + position + 6;
+        if (qChecksum(payload, length) != checksum) break;
+        
+        Record record;
+        quint8 operation;
+        QByteArray recordBytes = QByteArray::fromRawData(payload, static_cast<int>(length));
+        QDataStream stream(recordBytes);
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream >> record.revision >> operation >> record.numbers >> record.strings;
+        if (stream.status() != QDataStream::Ok) break;
+        record.operation = static_cast<Operation>(operation);
+        
+        position += 6 + length;
+        if (record.operation == Operation::Commit)
+        {
+            committed->append(pending);
+            pending.clear();
+            committedSize = position;
+        }
+        else
+        {
+            pending.append(record);
+        }
+    }
+    
+    return committedSize;
+}
+
+bool ProjectJournal::sync()
+{
+    if (!file.flush()) return false;
+#ifdef Q_OS_WIN
+    return (_commit(file.handle()) == 0);
+#else
+    return (fsync(file.handle()) == 0);
+#endif
+}
@@ -0,0 +1,73 @@
+#ifndef PROJECTJOURNAL_H
+#define PROJECTJOURNAL_H
+
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+
+// Append-only log of Project edits, kept next to the Project Files as "<project>.journal".
+// Every Record is framed as "quint32 length, quint16 qChecksum, payload", so a torn or corrupted tail is detected.
+// Records up to the last "Commit" are the saved state on top of the Project Files;
+// everything after it was never saved and is dropped on open.
+class ProjectJournal
+{
+public:
+    enum class Operation : quint8
+    {
+        AddVar = 1,
+        AddVarValue,
+        DeleteVar,
+        DeleteVarValue,
+        SetVarName,
+        SetVarValue,
+        AddRule,
+        AddIfPair,
+        AddThenPair,
+        DeleteRule,
+        DeleteIfPair,
+        DeleteThenPair,
+        Commit
+    };
+    
+    // Arguments of the Project method, with normalized ids in "numbers";
+    // "revision" is the Project revision after the edit
+    struct Record
+    {
+        quint64 revision;
+        Operation operation;
+        QVector<qint32> numbers;
+        QStringList strings;
+    };
+    
+public:
+    explicit ProjectJournal(const QString &filePath);
+    
+    // Reads committed Records and cuts off the rest of the File.
+    // Returns "false" if the File exists but can not be written; committed Records are read anyway
+    bool open(QList<Record> *committed);
+    
+    // Return "false" if writing failed; the Journal must not be used after that
+    bool append(const Record &record);
+    // Appends "Commit" and waits until the File is on disk
+    bool commit(quint64 revision);
+    // Empties the File once its Records are in the Project Files
+    bool clear();
+    
+    const QString &getFilePath() const;
+    qint64 getSize() const;
+    
+private:
+    // Returns the size of the File up to the end of the last "Commit"
+    qint64 readRecords(QList<Record> *committed);
+    bool sync();
+    
+private:
+    QString filePath;
+    QFile file;
+    
+};
+
+#endif // PROJECTJOURNAL_H
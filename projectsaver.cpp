@@ -0,0 +1,68 @@
+#include "projectsaver.h"
+
+#include <QCoreApplication>
+#include <QEvent>
+
+
+ProjectSaver::ProjectSaver(QObject *parent) :
+    QObject(parent),
+    hasPending(false),
+    running(false)
+{
+    connect(this, &ProjectSaver::written, this, &ProjectSaver::onWritten, Qt::QueuedConnection);
+}
+
+ProjectSaver::~ProjectSaver()
+{
+    // Results still queued are dropped together with this object
+    if (thread.joinable()) thread.join();
+}
+
+void ProjectSaver::save(const ProjectSnapshot &snapshot)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    pending = snapshot;
+    hasPending = true;
+    if (running) return;
+    
+    // The previous thread has already left "writeLoop"
+    if (thread.joinable()) thread.join();
+    running = true;
+    thread = std::thread(&ProjectSaver::writeLoop, this);
+}
+
+bool ProjectSaver::isBusy() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return running;
+}
+
+void ProjectSaver::wait()
+{
+    if (thread.joinable()) thread.join();
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+}
+
+void ProjectSaver::onWritten(quint64 revision, bool ok)
+{
+    emit finished(revision, ok);
+}
+
+void ProjectSaver::writeLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (hasPending)
+    {
+        ProjectSnapshot snapshot = pending;
+        // Drop the Lists here, so that the Project does not copy them on the next edit
+        pending = ProjectSnapshot();
+        hasPending = false;
+        lock.unlock();
+        
+        Error err = snapshot.write();
+        emit written(snapshot.getRevision(), !err);
+        
+        lock.lock();
+    }
+    running = false;
+}
@@ -0,0 +1,54 @@
+#ifndef PROJECTSAVER_H
+#define PROJECTSAVER_H
+
+#include "project.h"
+
+#include <QObject>
+
+#include <mutex>
+#include <thread>
+
+
+// Writes Project snapshots to the Project Files on its own thread, one at a time.
+// A snapshot requested while another one is being written replaces any snapshot still waiting,
+// since the newer one contains all its edits.
+// "finished" is emitted on the thread of the ProjectSaver; it is not emitted after the ProjectSaver is deleted
+class ProjectSaver : public QObject
+{
+    Q_OBJECT
+    
+public:
+    explicit ProjectSaver(QObject *parent = 0);
+    // Waits for the snapshots already requested
+    ~ProjectSaver();
+    
+    void save(const ProjectSnapshot &snapshot);
+    bool isBusy() const;
+    // Waits for the snapshots already requested and emits their "finished" before returning
+    void wait();
+    
+signals:
+    // "ok" is "false" if the Project Files could not be written
+    void finished(quint64 revision, bool ok);
+    
+    // Emitted by the writing thread, queued to "onWritten"
+    void written(quint64 revision, bool ok);
+    
+private slots:
+    void onWritten(quint64 revision, bool ok);
+    
+private:
+    void writeLoop();
+    
+private:
+    mutable std::mutex mutex;
+    std::thread thread;
+    
+    // Next snapshot to write
+    ProjectSnapshot pending;
+    bool hasPending;
+    bool running;
+    
+};
+
+#endif // PROJECTSAVER_H
@@ -0,0 +1,191 @@
+#include "resultcache.h"
+
+#include <algorithm>
+
+
+ResultCache::ResultCache(int capacity, int shardCount) :
+    hits(0),
+    misses(0),
+    evictions(0)
+{
+    if (shardCount <= 0) shardCount = 1;
+    shardCapacity = qMax(1, (capacity + shardCount - 1) / shardCount);
+    
+    for (int i = 0; i < shardCount; i++)
+    {
+        shards.emplace_back(new Shard);
+        shards.back()->clockHand = 0;
+    }
+}
+
+QMap<QString, QString> ResultCache::interpret(const Interpreter &interp, const QMap<QString, QString> &input)
+{
+    const SymbolTable &symbols = interp.getSymbols();
+    const std::vector<int> &inputVarIds = interp.getInputVarIds();
+    const std::vector<int> &outputVarIds = interp.getOutputVarIds();
+    
+    std::vector<quint16> inputCodes(inputVarIds.size(), 0);
+    int found = 0;
+    for (int k = 0; k < static_cast<int>(inputVarIds.size()); k++)
+    {
+        auto it = input.constFind(symbols.getVarName(inputVarIds[k]));
+        if (it == input.constEnd()) continue;
+        inputCodes[k] = symbols.getValueCode(inputVarIds[k], it.value());
+        found++;
+    }
+    
+    // Preset Values of other known Variables are not part of the key
+    if (found != input.size())
+    {
+        for (auto it = input.constBegin(); it != input.constEnd(); ++it)
+        {
+            int varId = symbols.getVarId(it.key());
+            if (varId == -1) continue;
+            if (std::find(inputVarIds.begin(), inputVarIds.end(), varId) == inputVarIds.end()) return interp.interpret(input);
+        }
+    }
+    
+    std::vector<quint16> outputCodes;
+    interpret(interp, inputCodes, outputCodes);
+    
+    QMap<QString, QString> output;
+    for (int k = 0; k < static_cast<int>(outputVarIds.size()); k++)
+    {
+        output[symbols.getVarName(outputVarIds[k])] = symbols.getValueName(outputVarIds[k], outputCodes[k]);
+    }
+    
+    return output;
+}
+
+void ResultCache::interpret(const Interpreter &interp, const std::vector<quint16> &inputCodes, std::vector<quint16> &outputCodes)
+{
+    quint64 fingerprint = interp.getFingerprint();
+    quint64 hash = hashKey(fingerprint, inputCodes);
+    Shard &shard = *shards[hash % shards.size()];
+    
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        
+        auto it = shard.index.constFind(hash);
+        if (it != shard.index.constEnd())
+        {
+            Entry &entry = shard.entries[it.value()];
+            if (entry.fingerprint == fingerprint && entry.key == inputCodes)
+            {
+                entry.referenced = true;
+                outputCodes = entry.value;
+                hits++;
+                return;
+            }
+        }
+    }
+    
+    misses++;
+    
+    // Interpreting outside of the lock lets other threads use the shard meanwhile
+    outputCodes.assign(interp.getOutputVarIds().size(), 0);
+    
+    // Column lists are kept by the thread, so misses do not allocate them again
+    static thread_local Interpreter::BatchInput batchInput;
+    static thread_local Interpreter::BatchOutput batchOutput;
+    batchInput.rowCount = 1;
+    batchInput.columns.clear();
+    for (const quint16 &code : inputCodes)
+    {
+        batchInput.columns.push_back(&code);
+    }
+    batchOutput.columns.clear();
+    for (quint16 &code : outputCodes)
+    {
+        batchOutput.columns.push_back(&code);
+    }
+    
+    interp.interpretBatch(batchInput, batchOutput);
+    
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    insert(shard, hash, fingerprint, inputCodes, outputCodes);
+}
+
+void ResultCache::clear()
+{
+    for (auto &shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->entries.clear();
+        shard->index.clear();
+        shard->clockHand = 0;
+    }
+}
+
+quint64 ResultCache::getHitCount() const
+{
+    return hits;
+}
+
+quint64 ResultCache::getMissCount() const
+{
+    return misses;
+}
+
+quint64 ResultCache::getEvictionCount() const
+{
+    return evictions;
+}
+
+quint64 ResultCache::hashKey(quint64 fingerprint, const std::vector<quint16> &key)
+{
+    // FNV-1a over the fingerprint and the codes, then a final mix, since shard and index both take the low bits
+    quint64 hash = Q_UINT64_C(14695981039346656037);
+    for (int shift = 0; shift < 64; shift += 16)
+    {
+        hash ^= (fingerprint >> shift) & 0xffff;
+        hash *= Q_UINT64_C(1099511628211);
+    }
+    for (quint16 code : key)
+    {
+        hash ^= code;
+        hash *= Q_UINT64_C(1099511628211);
+    }
+    
+    hash ^= hash >> 33;
+    hash *= Q_UINT64_C(0xff51afd7ed558ccd);
+    hash ^= hash >> 33;
+    return hash;
+}
+
+void ResultCache::insert(Shard &shard, quint64 hash, quint64 fingerprint, const std::vector<quint16> &key, const std::vector<quint16> &value)
+{
+    // Another thread may have added the same key, or a key with the same hash
+    auto it = shard.index.constFind(hash);
+    if (it != shard.index.constEnd())
+    {
+        Entry &entry = shard.entries[it.value()];
+        entry.fingerprint = fingerprint;
+        entry.key = key;
+        entry.value = value;
+        entry.referenced = true;
+        return;
+    }
+    
+    if (static_cast<int>(shard.entries.size()) < shardCapacity)
+    {
+        shard.index.insert(hash, static_cast<int>(shard.entries.size()));
+        shard.entries.push_back(Entry{hash, fingerprint, key, value, false});
+        return;
+    }
+    
+    // CLOCK: recently used Entries get a second chance
+    while (shard.entries[shard.clockHand].referenced)
+    {
+        shard.entries[shard.clockHand].referenced = false;
+        shard.clockHand = (shard.clockHand + 1) % shardCapacity;
+    }
+    
+    Entry &victim = shard.entries[shard.clockHand];
+    shard.index.remove(victim.hash);
+    evictions++;
+    
+    victim = Entry{hash, fingerprint, key, value, false};
+    shard.index.insert(hash, shard.clockHand);
+    shard.clockHand = (shard.clockHand + 1) % shardCapacity;
+}
@@ -0,0 +1,70 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include "interpreter.h"
+
+#include <QHash>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+// Bounded concurrent cache of Interpreter results keyed by the Interpreter fingerprint and encoded Input Values,
+// so several Interpreters may share one cache; entries of an Interpreter that is not asked any more age out.
+// Entries are spread over shards with their own lock; a full shard evicts with the CLOCK algorithm.
+class ResultCache
+{
+public:
+    explicit ResultCache(int capacity = 65536, int shardCount = 16);
+    
+    ResultCache(const ResultCache &) = delete;
+    ResultCache &operator=(const ResultCache &) = delete;
+    
+public:
+    QMap<QString, QString> interpret(const Interpreter &interp, const QMap<QString, QString> &input);
+    // "inputCodes" are in the order of "Interpreter::getRequiredInputVarList()",
+    // "outputCodes" are filled in the order of "Interpreter::getOutputVarList()"
+    void interpret(const Interpreter &interp, const std::vector<quint16> &inputCodes, std::vector<quint16> &outputCodes);
+    
+    void clear();
+    
+    quint64 getHitCount() const;
+    quint64 getMissCount() const;
+    quint64 getEvictionCount() const;
+    
+private:
+    struct Entry
+    {
+        quint64 hash;
+        quint64 fingerprint;
+        std::vector<quint16> key;
+        std::vector<quint16> value;
+        bool referenced;
+    };
+    
+    struct Shard
+    {
+        std::mutex mutex;
+        std::vector<Entry> entries;
+        // Hash of the key -> index in "entries"
+        QHash<quint64, int> index;
+        int clockHand;
+    };
+    
+private:
+    static quint64 hashKey(quint64 fingerprint, const std::vector<quint16> &key);
+    void insert(Shard &shard, quint64 hash, quint64 fingerprint, const std::vector<quint16> &key, const std::vector<quint16> &value);
+    
+private:
+    int shardCapacity;
+    std::vector<std::unique_ptr<Shard>> shards;
+    
+    std::atomic<quint64> hits;
+    std::atomic<quint64> misses;
+    std::atomic<quint64> evictions;
+    
+};
+
+#endif // RESULTCACHE_H
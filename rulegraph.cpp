@@ -0,0 +1,93 @@
+#include "rulegraph.h"
+
+
+RuleGraph::RuleGraph(const RuleProgram &program, const std::vector<quint8> &isInput) :
+    levelCount(0)
+{
+    int ruleCount = program.getRuleCount();
+    int varCount = static_cast<int>(program.readerBegin.size()) - 1;
+    
+    levels.assign(ruleCount, -1);
+    definedFrom.assign(varCount, -1);
+    
+    // Number of distinct IF-Variables of every Rule that are not defined yet
+    std::vector<int> waiting(ruleCount, 0);
+    for (int v = 0; v < varCount; v++)
+    {
+        for (quint32 k = program.readerBegin[v]; k < program.readerBegin[v + 1]; k++)
+        {
+            waiting[program.readers[k]]++;
+        }
+    }
+    
+    // Variables are processed in order of Level they are defined from,
+    // so the first Level found for a Rule or a Variable is the smallest one
+    std::vector<int> current;
+    std::vector<int> next;
+    
+    for (int v = 0; v < varCount; v++)
+    {
+        if (!isInput[v]) continue;
+        definedFrom[v] = 0;
+        current.push_back(v);
+    }
+    
+    auto placeRule = [&](int rule, int level)
+    {
+        levels[rule] = level;
+        levelCount = qMax(levelCount, level + 1);
+        
+        for (quint32 j = program.thenBegin[rule]; j < program.thenBegin[rule + 1]; j++)
+        {
+            int varId = program.thenVars[j];
+            if (definedFrom[varId] != -1) continue;
+            definedFrom[varId] = level + 1;
+            next.push_back(varId);
+        }
+    };
+    
+    for (int r = 0; r < ruleCount; r++)
+    {
+        if (waiting[r] == 0) placeRule(r, 0);
+    }
+    
+    for (int level = 0; !current.empty() || !next.empty(); level++)
+    {
+        for (int varId : current)
+        {
+            for (quint32 k = program.readerBegin[varId]; k < program.readerBegin[varId + 1]; k++)
+            {
+                int rule = program.readers[k];
+                if (--waiting[rule] == 0) placeRule(rule, level);
+            }
+        }
+        
+        current.swap(next);
+        next.clear();
+    }
+    
+    for (int r = 0; r < ruleCount; r++)
+    {
+        if (levels[r] == -1) unreachableRules.push_back(r);
+    }
+}
+
+const std::vector<int> &RuleGraph::getLevels() const
+{
+    return levels;
+}
+
+int RuleGraph::getLevelCount() const
+{
+    return levelCount;
+}
+
+const std::vector<int> &RuleGraph::getDefinedFrom() const
+{
+    return definedFrom;
+}
+
+const std::vector<int> &RuleGraph::getUnreachableRules() const
+{
+    return unreachableRules;
+}
@@ -0,0 +1,36 @@
+#ifndef RULEGRAPH_H
+#define RULEGRAPH_H
+
+#include "ruleprogram.h"
+
+
+// Dependency graph between Rules through the Variables they read and assign.
+// Input Variables are defined from Level "0"; a Variable assigned by a Rule of Level "l"
+// is defined from Level "l + 1" on; a Rule gets the first Level where all its IF-Variables are defined.
+// Works in O(Rules + Pairs); Rules that wait for a Variable nobody defines (or for themselves) get no Level.
+class RuleGraph
+{
+public:
+    // "program" must have its Variable index built; "isInput" is indexed by Variable id
+    RuleGraph(const RuleProgram &program, const std::vector<quint8> &isInput);
+    
+public:
+    // Level of every Rule of the program; "-1" means the Rule can never be evaluated
+    const std::vector<int> &getLevels() const;
+    int getLevelCount() const;
+    
+    // First Level where the Variable is defined; "-1" means never
+    const std::vector<int> &getDefinedFrom() const;
+    
+    // Rules with Level "-1", in program order
+    const std::vector<int> &getUnreachableRules() const;
+    
+private:
+    std::vector<int> levels;
+    std::vector<int> definedFrom;
+    std::vector<int> unreachableRules;
+    int levelCount;
+    
+};
+
+#endif // RULEGRAPH_H
@@ -0,0 +1,344 @@
+#include "ruleminimizer.h"
+#include "interpreter.h"
+
+#include <QHash>
+#include <QMap>
+
+#include <algorithm>
+
+
+RuleMinimizer::RuleMinimizer(const QStringList &varNames, const QList<QStringList> &varValues, const QList<Rule> &rules,
+                             int maxCheckedInputs) :
+    varNames(varNames),
+    varValues(varValues),
+    maxCheckedInputs(maxCheckedInputs),
+    rules(rules),
+    mergeCount(0)
+{
+    for (int r = 0; r < rules.length(); r++)
+    {
+        ruleSources.append(QList<int>() << r);
+    }
+    
+    for (bool merged = true; merged; )
+    {
+        merged = false;
+        
+        // Rules with equal THEN-blocks and equal IF-Pairs except the one on the key Variable;
+        // ordered, so merges are tried in the same order whatever the hash seed
+        QMap<QString, QList<int>> families;
+        QMap<QString, QString> familyVars;
+        for (int r = 0; r < this->rules.length(); r++)
+        {
+            const Rule &rule = this->rules.at(r);
+            
+            QStringList ifPairs;
+            for (const Pair &ifPair : rule.ifBlock)
+            {
+                ifPairs.append(ifPair.stringify(true));
+            }
+            ifPairs.sort();
+            
+            for (int i = 0; i < rule.ifBlock.length(); i++)
+            {
+                const QString &var = rule.ifBlock.at(i).var;
+                int varId = varNames.indexOf(var);
+                if (varId == -1 || varId >= varValues.length() || varValues.at(varId).length() < 2) continue;
+                
+                // Rules with several IF-Pairs on the Variable do not belong to any family
+                bool repeated = false;
+                for (int k = 0; k < rule.ifBlock.length(); k++)
+                {
+                    if (k != i && rule.ifBlock.at(k).var == var) repeated = true;
+                }
+                if (repeated) continue;
+                
+                QStringList otherPairs = ifPairs;
+                otherPairs.removeOne(rule.ifBlock.at(i).stringify(true));
+                QString key = var + "|" + otherPairs.join("&") + "|" + rule.stringifyThenBlock();
+                
+                families[key].append(r);
+                familyVars[key] = var;
+            }
+        }
+        
+        for (auto it = families.constBegin(); it != families.constEnd() && !merged; ++it)
+        {
+            if (rejected.contains(it.key())) continue;
+            
+            const QString &var = familyVars.value(it.key());
+            const QStringList &domain = varValues.at(varNames.indexOf(var));
+            
+            // Every Value of the domain at least once; repeated members are merged as well
+            QSet<QString> values;
+            QList<int> family;
+            for (int r : it.value())
+            {
+                for (const Pair &ifPair : this->rules.at(r).ifBlock)
+                {
+                    if (ifPair.var != var || !domain.contains(ifPair.value)) continue;
+                    values.insert(ifPair.value);
+                    family.append(r);
+                }
+            }
+            if (values.size() != domain.length()) continue;
+            
+            if (tryMerge(family, var)) merged = true;
+            else rejected.insert(it.key());
+        }
+    }
+}
+
+const QList<Rule> &RuleMinimizer::getRules() const
+{
+    return rules;
+}
+
+const QList<QList<int>> &RuleMinimizer::getRuleSources() const
+{
+    return ruleSources;
+}
+
+int RuleMinimizer::getMergeCount() const
+{
+    return mergeCount;
+}
+
+QStringList RuleMinimizer::stringifyReport() const
+{
+    return report;
+}
+
+RuleMinimizer::Compiled RuleMinimizer::compile(const QList<Rule> &ruleList) const
+{
+    Interpreter interp(varNames, varValues, ruleList);
+    
+    Compiled result;
+    result.order = interp.getProgram().ruleSource;
+    result.inputVars = interp.getRequiredInputVarList();
+    result.outputVars = interp.getOutputVarList();
+    
+    return result;
+}
+
+bool RuleMinimizer::tryMerge(const QList<int> &family, const QString &var)
+{
+    Compiled current = compile(rules);
+    // Inputs may be left unset, when no member fires but the merged Rule would
+    if (current.inputVars.contains(var)) return false;
+    
+    std::vector<int> position(rules.length(), -1);
+    for (int p = 0; p < static_cast<int>(current.order.size()); p++)
+    {
+        position[current.order[p]] = p;
+    }
+    
+    // Family as it is evaluated
+    int first = -1;
+    int last = -1;
+    for (int r : family)
+    {
+        if (position[r] == -1) return false;
+        first = (first == -1) ? position[r] : qMin(first, position[r]);
+        last = qMax(last, position[r]);
+    }
+    
+    const Rule &sample = rules.at(family.first());
+    QSet<QString> ifVars;
+    QHash<QString, QString> thenValues;
+    for (const Pair &ifPair : sample.ifBlock)
+    {
+        ifVars.insert(ifPair.var);
+    }
+    for (const Pair &thenPair : sample.thenBlock)
+    {
+        if (ifVars.contains(thenPair.var)) return false;
+        thenValues.insert(thenPair.var, thenPair.value);
+    }
+    
+    // Rule evaluated in between must not change the IF-Variables nor see the THEN-Variables;
+    // assigning the same Values is harmless, since the order of such assignments does not matter
+    auto interferes = [&](int r)
+    {
+        for (const Pair &ifPair : rules.at(r).ifBlock)
+        {
+            if (thenValues.contains(ifPair.var)) return true;
+        }
+        for (const Pair &thenPair : rules.at(r).thenBlock)
+        {
+            if (ifVars.contains(thenPair.var)) return true;
+            if (thenValues.contains(thenPair.var) && thenValues.value(thenPair.var) != thenPair.value) return true;
+        }
+        return false;
+    };
+    
+    for (int p = first + 1; p < last; p++)
+    {
+        int r = static_cast<int>(current.order[p]);
+        if (!family.contains(r) && interferes(r)) return false;
+    }
+    
+    Rule merged;
+    merged.thenBlock = sample.thenBlock;
+    for (const Pair &ifPair : sample.ifBlock)
+    {
+        if (ifPair.var != var) merged.ifBlock.append(ifPair);
+    }
+    
+    // Merged Rule takes the place of the first member
+    QList<int> members = family;
+    std::sort(members.begin(), members.end());
+    
+    QList<Rule> candidate;
+    QList<QList<int>> candidateSources;
+    QList<int> mergedSources;
+    // Old index of every Rule in "candidate", "-1" for the merged one
+    std::vector<int> oldIndex;
+    for (int r = 0; r < rules.length(); r++)
+    {
+        if (r == members.first())
+        {
+            candidate.append(merged);
+            candidateSources.append(QList<int>());
+            oldIndex.push_back(-1);
+        }
+        
+        if (members.contains(r))
+        {
+            mergedSources.append(ruleSources.at(r));
+            continue;
+        }
+        
+        candidate.append(rules.at(r));
+        candidateSources.append(ruleSources.at(r));
+        oldIndex.push_back(r);
+    }
+    std::sort(mergedSources.begin(), mergedSources.end());
+    candidateSources[members.first()] = mergedSources;
+    
+    // Levels must keep the order of all other Rules
+    Compiled result = compile(candidate);
+    if (result.inputVars != current.inputVars || result.outputVars != current.outputVars) return false;
+    
+    std::vector<int> expected;
+    int mergedMin = 0;
+    int mergedMax = 0;
+    for (int p = 0; p < static_cast<int>(current.order.size()); p++)
+    {
+        int r = static_cast<int>(current.order[p]);
+        if (family.contains(r)) continue;
+        
+        expected.push_back(r);
+        if (p < first) mergedMin++;
+        if (p < last) mergedMax++;
+    }
+    
+    std::vector<int> actual;
+    int mergedPosition = -1;
+    for (quint32 r : result.order)
+    {
+        if (oldIndex[r] == -1) mergedPosition = static_cast<int>(actual.size());
+        else actual.push_back(oldIndex[r]);
+    }
+    
+    if (actual != expected || mergedPosition == -1) return false;
+    
+    // Levels may move the merged Rule out of the place of the family, but not across an interfering Rule
+    for (int k = mergedPosition; k < mergedMin; k++)
+    {
+        if (interferes(expected[k])) return false;
+    }
+    for (int k = mergedMax; k < mergedPosition; k++)
+    {
+        if (interferes(expected[k])) return false;
+    }
+    
+    // Unset "var" matches no member but the merged Rule; only the results show whether it can be unset there
+    if (!haveSameResults(rules, candidate)) return false;
+    
+    QStringList memberNumbers;
+    for (int source : mergedSources)
+    {
+        memberNumbers.append(QString::number(source + 1));
+    }
+    report.append("Rules " + memberNumbers.join(", ") + " merged into : " + merged.stringify());
+    
+    rules = candidate;
+    ruleSources = candidateSources;
+    mergeCount++;
+    
+    return true;
+}
+
+bool RuleMinimizer::haveSameResults(const QList<Rule> &first, const QList<Rule> &second) const
+{
+    Interpreter firstInterp(varNames, varValues, first);
+    Interpreter secondInterp(varNames, varValues, second);
+    
+    // Declared Values have the same codes in both Interpreters; code "0" is unset
+    const std::vector<int> &inputVarIds = firstInterp.getInputVarIds();
+    qint64 total = 1;
+    std::vector<int> radixes;
+    for (int varId : inputVarIds)
+    {
+        int radix = firstInterp.getSymbols().getDomainSize(varId);
+        int declared = varNames.indexOf(firstInterp.getSymbols().getVarName(varId));
+        if (declared < varValues.length()) radix = qMin(radix, varValues.at(declared).length());
+        radix++;
+        
+        radixes.push_back(radix);
+        total *= radix;
+        if (total > maxCheckedInputs) return false;
+    }
+    
+    int rowCount = static_cast<int>(total);
+    std::vector<std::vector<quint16>> inputColumns(inputVarIds.size(), std::vector<quint16>(rowCount));
+    for (int row = 0; row < rowCount; row++)
+    {
+        int index = row;
+        for (int k = 0; k < static_cast<int>(radixes.size()); k++)
+        {
+            inputColumns[k][row] = static_cast<quint16>(index % radixes[k]);
+            index /= radixes[k];
+        }
+    }
+    
+    int outputCount = static_cast<int>(firstInterp.getOutputVarIds().size());
+    std::vector<std::vector<quint16>> firstOutput(outputCount, std::vector<quint16>(rowCount));
+    std::vector<std::vector<quint16>> secondOutput(outputCount, std::vector<quint16>(rowCount));
+    
+    Interpreter::BatchInput input;
+    input.rowCount = rowCount;
+    for (auto &column : inputColumns)
+    {
+        input.columns.push_back(column.data());
+    }
+    
+    Interpreter::BatchOutput firstBatch;
+    Interpreter::BatchOutput secondBatch;
+    for (int k = 0; k < outputCount; k++)
+    {
+        firstBatch.columns.push_back(firstOutput[k].data());
+        secondBatch.columns.push_back(secondOutput[k].data());
+    }
+    
+    firstInterp.interpretBatch(input, firstBatch);
+    secondInterp.interpretBatch(input, secondBatch);
+    
+    // Codes of Values missing in the declared domain may differ, so names are compared
+    for (int k = 0; k < outputCount; k++)
+    {
+        int firstVarId = firstInterp.getOutputVarIds()[k];
+        int secondVarId = secondInterp.getOutputVarIds()[k];
+        for (int row = 0; row < rowCount; row++)
+        {
+            if (firstInterp.getSymbols().getValueName(firstVarId, firstOutput[k][row])
+                    != secondInterp.getSymbols().getValueName(secondVarId, secondOutput[k][row]))
+            {
+                return false;
+            }
+        }
+    }
+    
+    return true;
+}
@@ -0,0 +1,63 @@
+#ifndef RULEMINIMIZER_H
+#define RULEMINIMIZER_H
+
+#include "project.h"
+
+#include <QSet>
+
+#include <vector>
+
+
+// Merges families of Rules that differ only in the Value of one IF-Variable and together cover its whole domain
+// into one Rule without that IF-Pair; merged Rules take part in further merges until nothing changes.
+// Results stay the same for all Inputs, unset ones included:
+// members must be equal in everything else, nothing between them in evaluation order may assign their
+// IF-Variables or touch their THEN-Variables, and the compiled order of all other Rules must not change.
+// Input Variables may be unset, so families on them are never merged; a merge on an assigned Variable is kept
+// only if results for all Inputs (declared Values or unset) are equal, and only if there are not more of them
+// than "maxCheckedInputs".
+class RuleMinimizer
+{
+public:
+    RuleMinimizer(const QStringList &varNames, const QList<QStringList> &varValues, const QList<Rule> &rules,
+                  int maxCheckedInputs = 1 << 14);
+    
+public:
+    const QList<Rule> &getRules() const;
+    // Indices in the source Rule list of the Rules every Rule from "getRules()" was merged from
+    const QList<QList<int>> &getRuleSources() const;
+    int getMergeCount() const;
+    QStringList stringifyReport() const;
+    
+private:
+    struct Compiled
+    {
+        // Indices in the Rule list, in evaluation order
+        std::vector<quint32> order;
+        QStringList inputVars;
+        QStringList outputVars;
+    };
+    
+private:
+    Compiled compile(const QList<Rule> &ruleList) const;
+    // Tries to merge Rules "family" of the current list, which cover domain of "var"
+    bool tryMerge(const QList<int> &family, const QString &var);
+    // Compares results of two Rule lists for all Inputs of declared Values or unset
+    bool haveSameResults(const QList<Rule> &first, const QList<Rule> &second) const;
+    
+private:
+    QStringList varNames;
+    QList<QStringList> varValues;
+    int maxCheckedInputs;
+    
+    QList<Rule> rules;
+    QList<QList<int>> ruleSources;
+    QStringList report;
+    int mergeCount;
+    
+    // Families that can not be merged, not to try them again
+    QSet<QString> rejected;
+    
+};
+
+#endif // RULEMINIMIZER_H
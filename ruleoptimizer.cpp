@@ -0,0 +1,317 @@
+#include "ruleoptimizer.h"
+#include "interpreter.h"
+
+#include <algorithm>
+
+
+namespace
+{
+
+// Whether some position of the sorted list lies in (first, last)
+bool hasPosition(const std::vector<int> &positions, int first, int last)
+{
+    auto it = std::upper_bound(positions.begin(), positions.end(), first);
+    return (it != positions.end() && *it < last);
+}
+    
+}
+
+RuleOptimizer::RuleOptimizer(const QStringList &varNames, const QList<QStringList> &varValues, const QList<Rule> &rules) :
+    varNames(varNames),
+    varValues(varValues),
+    sourceRules(rules),
+    locked(rules.length(), false)
+{
+    Compiled source = compileKept();
+    
+    for (int ruleId : source.unreachable)
+    {
+        remove(ruleId, Reason::UnassignedVariable, "some of its IF-Variables are never assigned");
+    }
+    findDeadRules();
+    findSubsumedRules(source.order);
+    
+    // Removed Rules never assign anything the remaining ones would not, but they may still define the Levels
+    // and the Input and Output Variables, so the result is compiled again and Rules are put back until it matches
+    for (;;)
+    {
+        Compiled kept = compileKept();
+        
+        bool removedMore = false;
+        for (int ruleId : kept.unreachable)
+        {
+            if (remove(ruleId, Reason::UnassignedVariable, "its IF-Variables are assigned only by removed Rules")) removedMore = true;
+        }
+        if (removedMore) continue;
+        
+        if (kept.inputVars != source.inputVars || kept.outputVars != source.outputVars)
+        {
+            QSet<QString> changed;
+            for (const QString &var : source.inputVars + source.outputVars + kept.inputVars + kept.outputVars)
+            {
+                bool wasInput = source.inputVars.contains(var), isInput = kept.inputVars.contains(var);
+                bool wasOutput = source.outputVars.contains(var), isOutput = kept.outputVars.contains(var);
+                if (wasInput != isInput || wasOutput != isOutput) changed.insert(var);
+            }
+            
+            // Readers define Input Variables, writers define the Output ones and keep Variables from becoming Inputs
+            if (restore(source.order, changed)) continue;
+        }
+        else
+        {
+            std::vector<quint32> expected;
+            for (quint32 ruleId : source.order)
+            {
+                if (!removed.contains(static_cast<int>(ruleId))) expected.push_back(ruleId);
+            }
+            for (int ruleId : kept.unreachable)
+            {
+                expected.erase(std::remove(expected.begin(), expected.end(), static_cast<quint32>(ruleId)), expected.end());
+            }
+            
+            if (kept.order == expected) break;
+        }
+        
+        // Rules are put back one at a time, so only those needed for the same result are kept
+        if (restore(source.order, QSet<QString>())) continue;
+        // Nothing is removed any more, so the result is the source one
+        break;
+    }
+    
+    for (int r = 0; r < sourceRules.length(); r++)
+    {
+        if (removed.contains(r))
+        {
+            removedRules.append(removed.value(r));
+            continue;
+        }
+        
+        this->rules.append(sourceRules.at(r));
+        ruleSource.append(r);
+    }
+}
+
+const QList<Rule> &RuleOptimizer::getRules() const
+{
+    return rules;
+}
+
+const QList<int> &RuleOptimizer::getRuleSource() const
+{
+    return ruleSource;
+}
+
+const QList<RuleOptimizer::RemovedRule> &RuleOptimizer::getRemovedRules() const
+{
+    return removedRules;
+}
+
+QStringList RuleOptimizer::stringifyReport() const
+{
+    QStringList result;
+    
+    for (const RemovedRule &removedRule : removedRules)
+    {
+        result.append("Rule " + QString::number(removedRule.ruleId + 1) + " removed : " + removedRule.details);
+    }
+    
+    return result;
+}
+
+RuleOptimizer::Compiled RuleOptimizer::compileKept() const
+{
+    QList<Rule> keptRules;
+    QList<int> keptSource;
+    for (int r = 0; r < sourceRules.length(); r++)
+    {
+        if (removed.contains(r)) continue;
+        keptRules.append(sourceRules.at(r));
+        keptSource.append(r);
+    }
+    
+    Interpreter interp(varNames, varValues, keptRules);
+    
+    Compiled result;
+    for (quint32 ruleId : interp.getProgram().ruleSource)
+    {
+        result.order.push_back(static_cast<quint32>(keptSource.at(ruleId)));
+    }
+    for (int ruleId : interp.getUnreachableRuleList())
+    {
+        result.unreachable.append(keptSource.at(ruleId));
+    }
+    result.inputVars = interp.getRequiredInputVarList();
+    result.outputVars = interp.getOutputVarList();
+    
+    return result;
+}
+
+void RuleOptimizer::findDeadRules()
+{
+    // Values that Rules may assign, besides the declared ones
+    QHash<QString, QSet<QString>> assignedValues;
+    for (const Rule &rule : sourceRules)
+    {
+        for (const Pair &thenPair : rule.thenBlock)
+        {
+            assignedValues[thenPair.var].insert(thenPair.value);
+        }
+    }
+    
+    for (int r = 0; r < sourceRules.length(); r++)
+    {
+        const Rule &rule = sourceRules.at(r);
+        
+        for (int i = 0; i < rule.ifBlock.length(); i++)
+        {
+            const Pair &ifPair = rule.ifBlock.at(i);
+            
+            for (int k = 0; k < i; k++)
+            {
+                const Pair &otherPair = rule.ifBlock.at(k);
+                if (otherPair.var == ifPair.var && otherPair.value != ifPair.value)
+                {
+                    remove(r, Reason::Contradiction, otherPair.stringify(true) + " and " + ifPair.stringify(true) + " can not hold together");
+                }
+            }
+            
+            int varId = varNames.indexOf(ifPair.var);
+            if (varId == -1 || varId >= varValues.length()) continue;
+            if (varValues.at(varId).contains(ifPair.value) || assignedValues.value(ifPair.var).contains(ifPair.value)) continue;
+            
+            remove(r, Reason::UnknownValue, "Value \"" + ifPair.value + "\" is not in the domain of Variable \"" + ifPair.var + "\"");
+        }
+        
+        if (rule.thenBlock.isEmpty()) remove(r, Reason::EmptyThenBlock, "THEN-block is empty");
+    }
+}
+
+void RuleOptimizer::findSubsumedRules(const std::vector<quint32> &order)
+{
+    // Positions in the evaluation order of Rules reading and assigning every Variable
+    std::vector<int> position(sourceRules.length(), -1);
+    QHash<QString, std::vector<int>> readerPositions;
+    QHash<QString, std::vector<int>> writerPositions;
+    // Candidates have equal THEN-blocks; ordered, so the result does not depend on the hash seed
+    QMap<QString, QList<int>> groups;
+    
+    for (int p = 0; p < static_cast<int>(order.size()); p++)
+    {
+        int r = static_cast<int>(order[p]);
+        position[r] = p;
+        
+        // Removed Rules never fire
+        if (removed.contains(r)) continue;
+        
+        const Rule &rule = sourceRules.at(r);
+        for (const Pair &ifPair : rule.ifBlock)
+        {
+            std::vector<int> &readers = readerPositions[ifPair.var];
+            if (readers.empty() || readers.back() != p) readers.push_back(p);
+        }
+        for (const Pair &thenPair : rule.thenBlock)
+        {
+            std::vector<int> &writers = writerPositions[thenPair.var];
+            if (writers.empty() || writers.back() != p) writers.push_back(p);
+        }
+        
+        groups[rule.stringifyThenBlock()].append(r);
+    }
+    
+    for (const QList<int> &group : groups)
+    {
+        for (int a : group)
+        {
+            if (locked[a] || removed.contains(a)) continue;
+            const Rule &ruleA = sourceRules.at(a);
+            
+            for (int b : group)
+            {
+                if (b == a || removed.contains(b)) continue;
+                const Rule &ruleB = sourceRules.at(b);
+                
+                bool subset = std::all_of(ruleB.ifBlock.begin(), ruleB.ifBlock.end(),
+                                          [&](const Pair &ifPair) { return ruleA.ifBlock.contains(ifPair); });
+                if (!subset) continue;
+                
+                // Whenever A fires, B must fire too with the same IF-Values, and nobody may see the difference in between
+                int pa = position[a];
+                int pb = position[b];
+                bool safe = true;
+                
+                if (pa < pb)
+                {
+                    for (const Pair &ifPair : ruleB.ifBlock)
+                    {
+                        if (hasPosition(writerPositions.value(ifPair.var), pa - 1, pb)) safe = false;
+                    }
+                    for (const Pair &thenPair : ruleA.thenBlock)
+                    {
+                        if (hasPosition(readerPositions.value(thenPair.var), pa, pb)) safe = false;
+                    }
+                }
+                else
+                {
+                    for (const Pair &ifPair : ruleB.ifBlock)
+                    {
+                        if (hasPosition(writerPositions.value(ifPair.var), pb, pa)) safe = false;
+                    }
+                    for (const Pair &thenPair : ruleA.thenBlock)
+                    {
+                        if (hasPosition(writerPositions.value(thenPair.var), pb, pa)) safe = false;
+                    }
+                }
+                if (!safe) continue;
+                
+                remove(a, Reason::Subsumed, "Rule " + QString::number(b + 1) + " has a subset of its IF-Pairs and the same THEN-block");
+                locked[b] = true;
+                break;
+            }
+        }
+    }
+}
+
+bool RuleOptimizer::restore(const std::vector<quint32> &order, const QSet<QString> &vars)
+{
+    std::vector<int> candidates(order.begin(), order.end());
+    std::vector<bool> inOrder(sourceRules.length(), false);
+    for (quint32 r : order)
+    {
+        inOrder[r] = true;
+    }
+    // Rules missing in the order were unreachable from the start
+    for (int r = 0; r < sourceRules.length(); r++)
+    {
+        if (!inOrder[r]) candidates.push_back(r);
+    }
+    
+    for (int r : candidates)
+    {
+        if (!removed.contains(r)) continue;
+        
+        const Rule &rule = sourceRules.at(r);
+        bool uses = vars.isEmpty();
+        for (const Pair &ifPair : rule.ifBlock)
+        {
+            if (vars.contains(ifPair.var)) uses = true;
+        }
+        for (const Pair &thenPair : rule.thenBlock)
+        {
+            if (vars.contains(thenPair.var)) uses = true;
+        }
+        if (!uses) continue;
+        
+        removed.remove(r);
+        locked[r] = true;
+        return true;
+    }
+    
+    return false;
+}
+
+bool RuleOptimizer::remove(int ruleId, Reason reason, const QString &details)
+{
+    if (locked[ruleId] || removed.contains(ruleId)) return false;
+    removed.insert(ruleId, RemovedRule{ruleId, reason, details});
+    return true;
+}
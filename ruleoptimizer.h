@@ -0,0 +1,91 @@
+#ifndef RULEOPTIMIZER_H
+#define RULEOPTIMIZER_H
+
+#include "project.h"
+
+#include <QHash>
+#include <QMap>
+#include <QSet>
+
+#include <vector>
+
+
+// Removes Rules that do not change any result of the Interpreter:
+// Rules that can never fire and Rules subsumed by a more general Rule with the same THEN-block.
+// Works on a copy of the Rules; the evaluation order of the remaining Rules is checked to stay the same,
+// and removed Rules are put back until it does.
+class RuleOptimizer
+{
+public:
+    enum class Reason : int
+    {
+        // Some IF-Variable is never assigned
+        UnassignedVariable,
+        // IF-Pair expects a Value that is neither in the Variable domain nor assigned by any Rule
+        UnknownValue,
+        // Two IF-Pairs expect different Values of one Variable
+        Contradiction,
+        EmptyThenBlock,
+        // Another Rule with a subset of IF-Pairs assigns the same
+        Subsumed
+    };
+    
+    struct RemovedRule
+    {
+        // Index in the source Rule list
+        int ruleId;
+        Reason reason;
+        // Human readable explanation
+        QString details;
+    };
+    
+public:
+    RuleOptimizer(const QStringList &varNames, const QList<QStringList> &varValues, const QList<Rule> &rules);
+    
+public:
+    const QList<Rule> &getRules() const;
+    // Index in the source Rule list of every Rule from "getRules()"
+    const QList<int> &getRuleSource() const;
+    // Ordered by "ruleId"
+    const QList<RemovedRule> &getRemovedRules() const;
+    QStringList stringifyReport() const;
+    
+private:
+    // What the Interpreter makes of the kept Rules; Rules are source indices
+    struct Compiled
+    {
+        std::vector<quint32> order;
+        QList<int> unreachable;
+        QStringList inputVars;
+        QStringList outputVars;
+    };
+    
+private:
+    Compiled compileKept() const;
+    void findDeadRules();
+    // "order" is the evaluation order of the Interpreter
+    void findSubsumedRules(const std::vector<quint32> &order);
+    // Puts back the first removed Rule, in "order", that reads or assigns one of "vars" (any Rule if it is empty);
+    // returns "false" if there is none
+    bool restore(const std::vector<quint32> &order, const QSet<QString> &vars);
+    
+    // Returns "false" if the Rule is locked or already removed
+    bool remove(int ruleId, Reason reason, const QString &details);
+    
+private:
+    QStringList varNames;
+    QList<QStringList> varValues;
+    QList<Rule> sourceRules;
+    
+    // Removal of every source Rule, empty if the Rule is kept
+    QHash<int, RemovedRule> removed;
+    // Rules that must stay, because others were removed in their favour or keeping the order needed them
+    std::vector<bool> locked;
+    
+    QList<Rule> rules;
+    QList<int> ruleSource;
+    QList<RemovedRule> removedRules;
+    
+};
+
+#endif // RULEOPTIMIZER_H
@@ -0,0 +1,168 @@
+#include "ruleprogram.h"
+
+// Levels with fewer Rules testing one Variable are walked Rule by Rule
+static const int minDispatchRules = 4;
+
+void RuleProgram::buildVarIndex(int varCount)
+{
+    int ruleCount = getRuleCount();
+    
+    // Counting sort by Variable keeps Rules of every Variable in evaluation order
+    readerBegin.assign(varCount + 1, 0);
+    writerBegin.assign(varCount + 1, 0);
+    
+    for (int r = 0; r < ruleCount; r++)
+    {
+        for (quint32 i = ifBegin[r]; i < ifBegin[r + 1]; i++)
+        {
+            // Several IF-Pairs of one Rule on the same Variable give one entry
+            bool repeated = false;
+            for (quint32 k = ifBegin[r]; k < i; k++)
+            {
+                if (ifVars[k] == ifVars[i]) repeated = true;
+            }
+            if (!repeated) readerBegin[ifVars[i] + 1]++;
+        }
+    }
+    
+    for (quint32 varId : thenVars)
+    {
+        writerBegin[varId + 1]++;
+    }
+    
+    for (int v = 0; v < varCount; v++)
+    {
+        readerBegin[v + 1] += readerBegin[v];
+        writerBegin[v + 1] += writerBegin[v];
+    }
+    
+    readers.resize(readerBegin[varCount]);
+    writerRules.resize(writerBegin[varCount]);
+    writerValues.resize(writerBegin[varCount]);
+    
+    std::vector<quint32> readerFill(readerBegin.begin(), readerBegin.end() - 1);
+    std::vector<quint32> writerFill(writerBegin.begin(), writerBegin.end() - 1);
+    
+    for (int r = 0; r < ruleCount; r++)
+    {
+        for (quint32 i = ifBegin[r]; i < ifBegin[r + 1]; i++)
+        {
+            quint32 varId = ifVars[i];
+            quint32 last = readerFill[varId];
+            if (last > readerBegin[varId] && readers[last - 1] == static_cast<quint32>(r)) continue;
+            readers[readerFill[varId]++] = static_cast<quint32>(r);
+        }
+        
+        for (quint32 j = thenBegin[r]; j < thenBegin[r + 1]; j++)
+        {
+            quint32 varId = thenVars[j];
+            writerRules[writerFill[varId]] = static_cast<quint32>(r);
+            writerValues[writerFill[varId]] = thenValues[j];
+            writerFill[varId]++;
+        }
+    }
+}
+
+void RuleProgram::buildDispatchIndex(const std::vector<int> &domainSizes)
+{
+    int levelCount = getLevelCount();
+    int varCount = static_cast<int>(domainSizes.size());
+    
+    dispatchVars.assign(levelCount, -1);
+    dispatchBase.assign(levelCount, 0);
+    dispatchBegin.clear();
+    dispatchRules.clear();
+    residualBegin.assign(1, 0);
+    residualRules.clear();
+    
+    // Stamps are "level + 1", so zero-filled vectors need no reset between Levels
+    std::vector<int> readCount(varCount, 0);
+    std::vector<int> readStamp(varCount, 0);
+    std::vector<int> writeStamp(varCount, 0);
+    std::vector<int> ruleStamp(varCount, -1);
+    std::vector<int> touched;
+    
+    for (int l = 0; l < levelCount; l++)
+    {
+        int stamp = l + 1;
+        touched.clear();
+        
+        for (quint32 r = levelBegin[l]; r < levelBegin[l + 1]; r++)
+        {
+            for (quint32 j = thenBegin[r]; j < thenBegin[r + 1]; j++)
+            {
+                writeStamp[thenVars[j]] = stamp;
+            }
+            
+            for (quint32 i = ifBegin[r]; i < ifBegin[r + 1]; i++)
+            {
+                quint32 varId = ifVars[i];
+                if (ruleStamp[varId] == static_cast<int>(r)) continue;
+                ruleStamp[varId] = static_cast<int>(r);
+                
+                if (readStamp[varId] != stamp)
+                {
+                    readStamp[varId] = stamp;
+                    readCount[varId] = 0;
+                    touched.push_back(static_cast<int>(varId));
+                }
+                readCount[varId]++;
+            }
+        }
+        
+        // Most tested Variable; it must not change while the Level is evaluated
+        int best = -1;
+        for (int varId : touched)
+        {
+            if (writeStamp[varId] == stamp || domainSizes[varId] < 2) continue;
+            if (readCount[varId] < minDispatchRules) continue;
+            if (best == -1 || readCount[varId] > readCount[best]) best = varId;
+        }
+        
+        if (best != -1)
+        {
+            dispatchVars[l] = best;
+            dispatchBase[l] = static_cast<quint32>(dispatchBegin.size());
+            
+            // Counting sort by the tested Value
+            int bucketCount = domainSizes[best] + 1;
+            std::vector<quint32> bucketSize(bucketCount + 1, 0);
+            std::vector<qint32> ruleBucket;
+            
+            for (quint32 r = levelBegin[l]; r < levelBegin[l + 1]; r++)
+            {
+                qint32 bucket = -1;
+                for (quint32 i = ifBegin[r]; i < ifBegin[r + 1]; i++)
+                {
+                    if (ifVars[i] == static_cast<quint32>(best))
+                    {
+                        bucket = ifValues[i];
+                        break;
+                    }
+                }
+                
+                ruleBucket.push_back(bucket);
+                if (bucket == -1) residualRules.push_back(r);
+                else bucketSize[bucket + 1]++;
+            }
+            
+            quint32 first = static_cast<quint32>(dispatchRules.size());
+            for (int b = 0; b < bucketCount; b++)
+            {
+                bucketSize[b + 1] += bucketSize[b];
+            }
+            for (int b = 0; b <= bucketCount; b++)
+            {
+                dispatchBegin.push_back(first + bucketSize[b]);
+            }
+            
+            dispatchRules.resize(first + bucketSize[bucketCount]);
+            for (quint32 r = levelBegin[l], k = 0; r < levelBegin[l + 1]; r++, k++)
+            {
+                if (ruleBucket[k] != -1) dispatchRules[first + bucketSize[ruleBucket[k]]++] = r;
+            }
+        }
+        
+        residualBegin.push_back(static_cast<quint32>(residualRules.size()));
+    }
+}
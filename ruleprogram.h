@@ -0,0 +1,67 @@
+#ifndef RULEPROGRAM_H
+#define RULEPROGRAM_H
+
+#include <QtGlobal>
+
+#include <vector>
+
+
+// Rules compiled into flat Structure-of-Arrays tables, stored in evaluation order.
+// Rule "r" owns IF-Pairs [ifBegin[r], ifBegin[r + 1]) and THEN-Pairs [thenBegin[r], thenBegin[r + 1]);
+// Level "l" owns Rules [levelBegin[l], levelBegin[l + 1]).
+struct RuleProgram
+{
+    RuleProgram() : ifBegin(1, 0), thenBegin(1, 0), levelBegin(1, 0) {}
+    
+    inline int getRuleCount() const { return static_cast<int>(ifBegin.size()) - 1; }
+    inline int getLevelCount() const { return static_cast<int>(levelBegin.size()) - 1; }
+    
+    // Closes current Rule; its Pairs must be already appended
+    inline void endRule()
+    {
+        ifBegin.push_back(static_cast<quint32>(ifVars.size()));
+        thenBegin.push_back(static_cast<quint32>(thenVars.size()));
+    }
+    
+    // Closes current Level; its Rules must be already appended
+    inline void endLevel() { levelBegin.push_back(static_cast<quint32>(getRuleCount())); }
+    
+    // Fills Variable -> Rule indices below; must be called after the last Rule is added
+    void buildVarIndex(int varCount);
+    // Fills Value dispatch tables below; "domainSizes[v]" is the number of Values of Variable "v" without "0"
+    void buildDispatchIndex(const std::vector<int> &domainSizes);
+    
+    std::vector<quint32> ifVars;
+    std::vector<quint16> ifValues;
+    std::vector<quint32> thenVars;
+    std::vector<quint16> thenValues;
+    
+    std::vector<quint32> ifBegin;
+    std::vector<quint32> thenBegin;
+    std::vector<quint32> levelBegin;
+    
+    // Index of every Rule in the Rule list it was compiled from
+    std::vector<quint32> ruleSource;
+    
+    // Rules with IF-Pairs on Variable "v" are readers[readerBegin[v], readerBegin[v + 1]), in evaluation order
+    std::vector<quint32> readerBegin;
+    std::vector<quint32> readers;
+    // THEN-Pairs assigning Variable "v" are [writerBegin[v], writerBegin[v + 1]), in evaluation order;
+    // "writerRules" holds the Rule of the Pair, "writerValues" the assigned Value
+    std::vector<quint32> writerBegin;
+    std::vector<quint32> writerRules;
+    std::vector<quint16> writerValues;
+    
+    // Value dispatch: Level "l" is split by the Value of Variable "dispatchVars[l]" ("-1" if the Level is not split).
+    // Rules with an IF-Pair "Variable == code" are dispatchRules[dispatchBegin[b + code], dispatchBegin[b + code + 1]),
+    // where "b" is "dispatchBase[l]"; Rules without IF-Pair on the Variable are residualRules[residualBegin[l], residualBegin[l + 1]).
+    // All lists are in evaluation order.
+    std::vector<qint32> dispatchVars;
+    std::vector<quint32> dispatchBase;
+    std::vector<quint32> dispatchBegin;
+    std::vector<quint32> dispatchRules;
+    std::vector<quint32> residualBegin;
+    std::vector<quint32> residualRules;
+};
+
+#endif // RULEPROGRAM_H
@@ -0,0 +1,57 @@
+#include "specializationcache.h"
+
+
+SpecializationCache::SpecializationCache(const Interpreter &base, int capacity) :
+    base(base),
+    capacity(qMax(1, capacity))
+{
+    
+}
+
+std::shared_ptr<const Interpreter> SpecializationCache::get(const QMap<QString, QString> &pinnedInputs)
+{
+    const SymbolTable &symbols = base.getSymbols();
+    
+    std::vector<qint32> key;
+    QMap<QString, QString> known;
+    for (int varId : base.getInputVarIds())
+    {
+        auto it = pinnedInputs.constFind(symbols.getVarName(varId));
+        if (it == pinnedInputs.constEnd())
+        {
+            key.push_back(-1);
+            continue;
+        }
+        
+        key.push_back(symbols.getValueCode(varId, it.value()));
+        known.insert(it.key(), it.value());
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = interpreters.find(key);
+        if (it != interpreters.end()) return it->second;
+    }
+    
+    // Specializing outside of the lock; if another thread was faster, its result is kept
+    std::shared_ptr<const Interpreter> interp = std::make_shared<Interpreter>(base.specialize(known));
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    auto inserted = interpreters.insert(std::make_pair(key, interp));
+    if (!inserted.second) return inserted.first->second;
+    
+    insertionOrder.push_back(key);
+    if (static_cast<int>(insertionOrder.size()) > capacity)
+    {
+        interpreters.erase(insertionOrder.front());
+        insertionOrder.pop_front();
+    }
+    
+    return interp;
+}
+
+int SpecializationCache::getSize() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<int>(interpreters.size());
+}
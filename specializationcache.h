@@ -0,0 +1,37 @@
+#ifndef SPECIALIZATIONCACHE_H
+#define SPECIALIZATIONCACHE_H
+
+#include "interpreter.h"
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+// Residual Interpreters of one base Interpreter (see "Interpreter::specialize()"), one per tuple of pinned Values.
+// The oldest Interpreter is dropped when the cache is full; Interpreters already handed out stay valid.
+class SpecializationCache
+{
+public:
+    // "Interpreter" must outlive the cache
+    explicit SpecializationCache(const Interpreter &base, int capacity = 64);
+    
+public:
+    std::shared_ptr<const Interpreter> get(const QMap<QString, QString> &pinnedInputs);
+    
+    int getSize() const;
+    
+private:
+    const Interpreter &base;
+    int capacity;
+    
+    mutable std::mutex mutex;
+    // Key is the Value code of every Input Variable, "-1" if it is not pinned
+    std::map<std::vector<qint32>, std::shared_ptr<const Interpreter>> interpreters;
+    std::deque<std::vector<qint32>> insertionOrder;
+    
+};
+
+#endif // SPECIALIZATIONCACHE_H
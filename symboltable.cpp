@@ -0,0 +1,83 @@
+#include "symboltable.h"
+
+
+SymbolTable::SymbolTable()
+{
+    
+}
+
+SymbolTable::SymbolTable(const QStringList &varNames, const QList<QStringList> &varValues)
+{
+    for (int i = 0; i < varNames.length(); i++)
+    {
+        int varId = internVar(varNames.at(i));
+        
+        if (i < varValues.length())
+        {
+            for (const QString &value : varValues.at(i))
+            {
+                internValue(varId, value);
+            }
+        }
+    }
+}
+
+int SymbolTable::internVar(const QString &varName)
+{
+    auto it = varIds.constFind(varName);
+    if (it != varIds.constEnd()) return it.value();
+    
+    int varId = varNames.length();
+    varNames.append(varName);
+    varIds.insert(varName, varId);
+    
+    valueNames.append(QStringList() << QString());
+    valueCodes.append(QHash<QString, quint16>());
+    
+    return varId;
+}
+
+quint16 SymbolTable::internValue(int varId, const QString &value)
+{
+    // Empty Value is the same as "no value"
+    if (value.isEmpty()) return 0;
+    
+    auto it = valueCodes.at(varId).constFind(value);
+    if (it != valueCodes.at(varId).constEnd()) return it.value();
+    
+    quint16 code = static_cast<quint16>(valueNames.at(varId).length());
+    valueNames[varId].append(value);
+    valueCodes[varId].insert(value, code);
+    
+    return code;
+}
+
+int SymbolTable::getVarId(const QString &varName) const
+{
+    return varIds.value(varName, -1);
+}
+
+quint16 SymbolTable::getValueCode(int varId, const QString &value) const
+{
+    return valueCodes.at(varId).value(value, 0);
+}
+
+const QString &SymbolTable::getVarName(int varId) const
+{
+    return varNames.at(varId);
+}
+
+const QString &SymbolTable::getValueName(int varId, quint16 valueCode) const
+{
+    return valueNames.at(varId).at(valueCode);
+}
+
+int SymbolTable::getVarCount() const
+{
+    return varNames.length();
+}
+
+int SymbolTable::getDomainSize(int varId) const
+{
+    return valueNames.at(varId).length() - 1;
+}
@@ -0,0 +1,47 @@
+#ifndef SYMBOLTABLE_H
+#define SYMBOLTABLE_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+
+
+// Maps Variable Names and Values to dense integer ids.
+// Value code "0" is reserved for "no value", so codes of real Values start at "1".
+class SymbolTable
+{
+public:
+    SymbolTable();
+    SymbolTable(const QStringList &varNames, const QList<QStringList> &varValues);
+    
+public:
+    // Returns id of the Variable, adding it if it is not known yet
+    int internVar(const QString &varName);
+    // Returns code of the Value, adding it to the Variable domain if it is not known yet
+    quint16 internValue(int varId, const QString &value);
+    
+    // Returns "-1" if Variable is unknown
+    int getVarId(const QString &varName) const;
+    // Returns "0" if Value is unknown
+    quint16 getValueCode(int varId, const QString &value) const;
+    
+    const QString &getVarName(int varId) const;
+    // Code "0" gives empty string
+    const QString &getValueName(int varId, quint16 valueCode) const;
+    
+    int getVarCount() const;
+    // Number of Values of the Variable, without reserved "0"
+    int getDomainSize(int varId) const;
+    
+private:
+    QStringList varNames;
+    QHash<QString, int> varIds;
+    
+    // "valueNames[varId][0]" is always empty string
+    QList<QStringList> valueNames;
+    QList<QHash<QString, quint16>> valueCodes;
+    
+};
+
+#endif // SYMBOLTABLE_H
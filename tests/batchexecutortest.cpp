@@ -0,0 +1,70 @@
+#include "batchexecutortest.h"
+#include "testdata.h"
+#include "batchexecutor.h"
+
+#include <QThread>
+#include <QtTest>
+
+
+void BatchExecutorTest::sameAsInterpreter()
+{
+    TestProject proj(1, 4, 8, 4, 500);
+    Interpreter interp(proj.varNames, proj.varValues, proj.rules);
+    TestInput input(interp, 10000, 2);
+    
+    TestOutput expected(interp, input.input.rowCount);
+    interp.interpretBatch(input.input, expected.output);
+    
+    // Small chunks, so that threads steal from each other
+    BatchExecutor executor(interp, 4);
+    TestOutput result(interp, input.input.rowCount);
+    executor.interpretBatch(input.input, result.output, 64);
+    
+    QVERIFY(result == expected);
+    
+    BitsetInterpreter bitsetInterp(proj.varNames, proj.varValues, proj.rules);
+    BatchExecutor bitsetExecutor(bitsetInterp, 4);
+    TestOutput bitsetResult(interp, input.input.rowCount);
+    bitsetExecutor.interpretBatch(input.input, bitsetResult.output, 64);
+    
+    QVERIFY(bitsetResult == expected);
+}
+
+void BatchExecutorTest::scaling_data()
+{
+    QTest::addColumn<int>("threadCount");
+    QTest::addColumn<bool>("bitset");
+    
+    QList<int> threadCounts;
+    for (int threadCount = 1; threadCount < QThread::idealThreadCount(); threadCount *= 2)
+    {
+        threadCounts.append(threadCount);
+    }
+    threadCounts.append(QThread::idealThreadCount());
+    
+    for (int threadCount : threadCounts)
+    {
+        QTest::newRow(qPrintable(QString::number(threadCount) + " threads")) << threadCount << false;
+        QTest::newRow(qPrintable(QString::number(threadCount) + " threads, BitsetInterpreter")) << threadCount << true;
+    }
+}
+
+void BatchExecutorTest::scaling()
+{
+    QFETCH(int, threadCount);
+    QFETCH(bool, bitset);
+    
+    TestProject proj(3, 6, 16, 6, 2000);
+    Interpreter interp(proj.varNames, proj.varValues, proj.rules);
+    BitsetInterpreter bitsetInterp(proj.varNames, proj.varValues, proj.rules);
+    TestInput input(interp, 100000, 4);
+    TestOutput result(interp, input.input.rowCount);
+    
+    BatchExecutor executor(interp, threadCount);
+    BatchExecutor bitsetExecutor(bitsetInterp, threadCount);
+    BatchExecutor &used = (bitset ? bitsetExecutor : executor);
+    QBENCHMARK
+    {
+        used.interpretBatch(input.input, result.output);
+    }
+}
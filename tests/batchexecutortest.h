@@ -0,0 +1,19 @@
+#ifndef BATCHEXECUTORTEST_H
+#define BATCHEXECUTORTEST_H
+
+#include <QObject>
+
+
+class BatchExecutorTest : public QObject
+{
+    Q_OBJECT
+    
+private slots:
+    void sameAsInterpreter();
+    // Rows per second over thread counts, for both engines
+    void scaling_data();
+    void scaling();
+    
+};
+
+#endif // BATCHEXECUTORTEST_H
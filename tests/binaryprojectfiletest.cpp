@@ -0,0 +1,125 @@
+#include "binaryprojectfiletest.h"
+#include "binaryprojectfile.h"
+#include "project.h"
+
+#include <QtTest>
+
+
+namespace
+{
+
+void compareProjects(const Project &actual, const Project &expected)
+{
+    QCOMPARE(actual.getProjName(), expected.getProjName());
+    QCOMPARE(actual.getVarNames(), expected.getVarNames());
+    QCOMPARE(actual.getAllVarValues(), expected.getAllVarValues());
+    QCOMPARE(actual.getRulezzStringified(), expected.getRulezzStringified());
+}
+
+// Writes a small binary Project and returns its contents
+QByteArray binaryProject(const QString &folder)
+{
+    Project proj(folder, "source");
+    proj.addVar("a", {"x", "y"});
+    proj.addRule(Rule());
+    proj.addIfPair(Pair("a", "x"));
+    proj.addThenPair(Pair("a", "y"));
+    
+    QString filePath = folder + "/source.esb";
+    if (proj.exportProject(filePath, ProjectFormat::Binary)) return QByteArray();
+    QFile file(filePath);
+    if (!file.open(QFile::ReadOnly)) return QByteArray();
+    return file.readAll();
+}
+
+bool writeFile(const QString &filePath, const QByteArray &bytes)
+{
+    QFile file(filePath);
+    return (file.open(QFile::WriteOnly | QFile::Truncate) && file.write(bytes) == bytes.size());
+}
+    
+}
+
+void BinaryProjectFileTest::initTestCase()
+{
+    QVERIFY(dir.isValid());
+}
+
+void BinaryProjectFileTest::roundTrip()
+{
+    Project proj(dir.path(), "roundtrip");
+    QVERIFY(!proj.addVar("speed", {"high", "low"}));
+    QVERIFY(!proj.addVar("x", {"yes", "no"}));
+    QVERIFY(!proj.addVar("empty", {}));
+    
+    Rule rule;
+    rule.ifBlock = {Pair("speed", "high"), Pair("ghost", "boo")};
+    rule.thenBlock = {Pair("x", "maybe")};
+    QVERIFY(!proj.addRule(rule));
+    QVERIFY(!proj.addRule(Rule()));
+    rule.ifBlock.clear();
+    rule.thenBlock = {Pair("x", "yes"), Pair("speed", "low")};
+    QVERIFY(!proj.addRule(rule));
+    
+    QString binFilePath = dir.filePath("roundtrip.esb");
+    QVERIFY(!proj.exportProject(binFilePath, ProjectFormat::Binary));
+    QVERIFY(BinaryProjectFile::isBinaryProjectFile(binFilePath));
+    Project binary(binFilePath);
+    QVERIFY(!binary.getLoadError());
+    QVERIFY(binary.getFormat() == ProjectFormat::Binary);
+    compareProjects(binary, proj);
+    
+    QString textFilePath = dir.filePath("roundtrip2.esp");
+    QVERIFY(!binary.exportProject(textFilePath, ProjectFormat::Text));
+    QVERIFY(!BinaryProjectFile::isBinaryProjectFile(textFilePath));
+    Project text(textFilePath);
+    QVERIFY(!text.getLoadError());
+    compareProjects(text, proj);
+}
+
+void BinaryProjectFileTest::truncatedFile()
+{
+    QByteArray bytes = binaryProject(dir.filePath("truncated"));
+    QVERIFY(!bytes.isEmpty());
+    
+    BinaryProjectFile file;
+    QString filePath = dir.filePath("truncated/cut.esb");
+    for (int size : {bytes.size() - 4, BinaryProjectFile::headerSize, 10})
+    {
+        QVERIFY(writeFile(filePath, bytes.left(size)));
+        QVERIFY(!file.open(filePath));
+    }
+    
+    Project proj(filePath);
+    QVERIFY(proj.getLoadError().getCode() == ErrorCode::FileError);
+}
+
+void BinaryProjectFileTest::corruptFile()
+{
+    QByteArray bytes = binaryProject(dir.filePath("corrupt"));
+    QVERIFY(!bytes.isEmpty());
+    QString filePath = dir.filePath("corrupt/bad.esb");
+    BinaryProjectFile file;
+    
+    QVERIFY(writeFile(filePath, bytes));
+    QVERIFY(file.open(filePath));
+    file.close();
+    
+    // Second String offset, right after the header, past the String data
+    QByteArray bad = bytes;
+    qToLittleEndian<quint32>(0xffffffffu, reinterpret_cast<uchar *>(bad.data()) + BinaryProjectFile::headerSize + 4);
+    QVERIFY(writeFile(filePath, bad));
+    QVERIFY(!file.open(filePath));
+    
+    // Rule section offset past the end of the File
+    bad = bytes;
+    qToLittleEndian<quint64>(static_cast<quint64>(bytes.size()), reinterpret_cast<uchar *>(bad.data()) + 48);
+    QVERIFY(writeFile(filePath, bad));
+    QVERIFY(!file.open(filePath));
+    
+    // Other version
+    bad = bytes;
+    qToLittleEndian<quint32>(BinaryProjectFile::version + 1, reinterpret_cast<uchar *>(bad.data()) + 4);
+    QVERIFY(writeFile(filePath, bad));
+    QVERIFY(!file.open(filePath));
+}
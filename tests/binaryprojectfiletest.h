@@ -0,0 +1,26 @@
+#ifndef BINARYPROJECTFILETEST_H
+#define BINARYPROJECTFILETEST_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+
+class BinaryProjectFileTest : public QObject
+{
+    Q_OBJECT
+    
+private slots:
+    void initTestCase();
+    
+    // Text to binary to text keeps every Variable, Value and Rule, undeclared names and empty blocks included
+    void roundTrip();
+    // Truncated Files and Files with offsets out of range are refused
+    void truncatedFile();
+    void corruptFile();
+    
+private:
+    QTemporaryDir dir;
+    
+};
+
+#endif // BINARYPROJECTFILETEST_H
@@ -0,0 +1,76 @@
+#include "bitsetinterpretertest.h"
+#include "testdata.h"
+#include "bitsetinterpreter.h"
+
+#include <QtTest>
+
+
+void BitsetInterpreterTest::sameAsInterpreter_data()
+{
+    QTest::addColumn<int>("seed");
+    QTest::addColumn<int>("layerCount");
+    QTest::addColumn<int>("ruleCount");
+    
+    QTest::newRow("one level") << 1 << 2 << 50;
+    QTest::newRow("several levels") << 2 << 5 << 400;
+    // More Rules than fit into one segment
+    QTest::newRow("long segments") << 3 << 2 << 3000;
+}
+
+void BitsetInterpreterTest::sameAsInterpreter()
+{
+    QFETCH(int, seed);
+    QFETCH(int, layerCount);
+    QFETCH(int, ruleCount);
+    
+    TestProject proj(seed, layerCount, 8, 4, ruleCount);
+    Interpreter interp(proj.varNames, proj.varValues, proj.rules);
+    BitsetInterpreter bitsetInterp(proj.varNames, proj.varValues, proj.rules);
+    QCOMPARE(bitsetInterp.getOutputVarList(), interp.getOutputVarList());
+    
+    TestInput input(interp, 5000, seed + 100);
+    TestOutput expected(interp, input.input.rowCount);
+    interp.interpretBatch(input.input, expected.output);
+    TestOutput result(interp, input.input.rowCount);
+    bitsetInterp.interpretBatch(input.input, result.output);
+    QVERIFY(result == expected);
+    
+    for (int r = 0; r < 100; r++)
+    {
+        QCOMPARE(bitsetInterp.interpret(input.row(r)), interp.interpret(input.row(r)));
+    }
+}
+
+void BitsetInterpreterTest::speed_data()
+{
+    QTest::addColumn<bool>("bitset");
+    
+    QTest::newRow("Interpreter") << false;
+    QTest::newRow("BitsetInterpreter") << true;
+}
+
+void BitsetInterpreterTest::speed()
+{
+    QFETCH(bool, bitset);
+    
+    TestProject proj(4, 3, 16, 6, 4000);
+    Interpreter interp(proj.varNames, proj.varValues, proj.rules);
+    BitsetInterpreter bitsetInterp(proj.varNames, proj.varValues, proj.rules);
+    TestInput input(interp, 20000, 5);
+    TestOutput result(interp, input.input.rowCount);
+    
+    if (bitset)
+    {
+        QBENCHMARK
+        {
+            bitsetInterp.interpretBatch(input.input, result.output);
+        }
+    }
+    else
+    {
+        QBENCHMARK
+        {
+            interp.interpretBatch(input.input, result.output);
+        }
+    }
+}
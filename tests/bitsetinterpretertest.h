@@ -0,0 +1,19 @@
+#ifndef BITSETINTERPRETERTEST_H
+#define BITSETINTERPRETERTEST_H
+
+#include <QObject>
+
+
+class BitsetInterpreterTest : public QObject
+{
+    Q_OBJECT
+    
+private slots:
+    void sameAsInterpreter_data();
+    void sameAsInterpreter();
+    void speed_data();
+    void speed();
+    
+};
+
+#endif // BITSETINTERPRETERTEST_H
@@ -0,0 +1,125 @@
+#include "codegeneratortest.h"
+#include "testdata.h"
+#include "es_codegen/codegenerator.h"
+
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtTest>
+
+
+namespace
+{
+
+// "x1_2" becomes "x1__2-\"a\\", "v2" becomes "v2\n\t\"\\"; some names clash with the generated ones:
+// "X_names" with the Value names of "X", "unset_" and "unset__" with the unset Value
+QString awkwardVar(const QString &name)
+{
+    if (name == "x0_0") return "X_names";
+    if (name == "x0_1") return "X";
+    return QString(name).replace("_", "__") + "-\"a\\";
+}
+
+QString awkwardValue(const QString &name)
+{
+    if (name == "v0") return "unset_";
+    if (name == "v1") return "unset__";
+    return name + "\n\t\"\\";
+}
+    
+}
+
+void CodeGeneratorTest::sameAsInterpreter()
+{
+    QString compiler;
+    for (const char *name : {"c++", "g++", "clang++"})
+    {
+        compiler = QStandardPaths::findExecutable(name);
+        if (!compiler.isEmpty()) break;
+    }
+    if (compiler.isEmpty()) QSKIP("No C++ compiler found");
+    
+    TestProject proj(7, 4, 4, 3, 300);
+    for (int v = 0; v < proj.varNames.length(); v++)
+    {
+        proj.varNames[v] = awkwardVar(proj.varNames.at(v));
+        for (QString &value : proj.varValues[v])
+        {
+            value = awkwardValue(value);
+        }
+    }
+    for (Rule &rule : proj.rules)
+    {
+        for (QList<Pair> *block : {&rule.ifBlock, &rule.thenBlock})
+        {
+            for (Pair &pair : *block)
+            {
+                pair = Pair(awkwardVar(pair.var), awkwardValue(pair.value));
+            }
+        }
+    }
+    
+    Interpreter interp(proj.varNames, proj.varValues, proj.rules);
+    CodeGenerator generator(interp, "awkward \"name\"\n");
+    
+    TestInput input(interp, 500, 8);
+    TestOutput expected(interp, input.input.rowCount);
+    interp.interpretBatch(input.input, expected.output);
+    
+    // Driver prints the Output codes of every row, one row per line
+    const std::vector<int> &inputVarIds = interp.getInputVarIds();
+    const std::vector<int> &outputVarIds = interp.getOutputVarIds();
+    QString ns = generator.getNamespaceName();
+    QString driver;
+    driver.append("#include \"generated.h\"\n#include <cstdio>\n\nint main()\n{\n");
+    for (int row = 0; row < input.input.rowCount; row++)
+    {
+        driver.append("    {\n        " + ns + "::Input in;\n");
+        for (size_t k = 0; k < inputVarIds.size(); k++)
+        {
+            QString field = "in." + generator.getVarIdentifier(inputVarIds[k]);
+            driver.append("        " + field + " = static_cast<decltype(" + field + ")>(" + QString::number(input.columns[k][row]) + ");\n");
+        }
+        driver.append("        " + ns + "::Output out = " + ns + "::evaluate(in);\n");
+        for (int varId : outputVarIds)
+        {
+            driver.append("        std::printf(\"%u \", static_cast<unsigned>(out." + generator.getVarIdentifier(varId) + "));\n");
+        }
+        driver.append("        std::printf(\"\\n\");\n    }\n");
+    }
+    driver.append("    return 0;\n}\n");
+    
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QFile header(dir.filePath("generated.h"));
+    QVERIFY(header.open(QFile::WriteOnly));
+    header.write(generator.generateHeader().toUtf8());
+    header.close();
+    QFile driverFile(dir.filePath("driver.cpp"));
+    QVERIFY(driverFile.open(QFile::WriteOnly));
+    driverFile.write(driver.toUtf8());
+    driverFile.close();
+    
+    QProcess compile;
+    compile.setWorkingDirectory(dir.path());
+    compile.start(compiler, {"-std=c++17", "-o", "driver", "driver.cpp"});
+    QVERIFY(compile.waitForFinished(300000));
+    QVERIFY2(compile.exitCode() == 0, compile.readAllStandardError().constData());
+    
+    QProcess run;
+    run.start(dir.filePath("driver"), QStringList());
+    QVERIFY(run.waitForFinished(60000));
+    QCOMPARE(run.exitCode(), 0);
+    
+    QStringList lines = QString::fromUtf8(run.readAllStandardOutput()).split("\n", QString::SkipEmptyParts);
+    QCOMPARE(lines.length(), input.input.rowCount);
+    for (int row = 0; row < input.input.rowCount; row++)
+    {
+        QStringList codes;
+        for (const std::vector<quint16> &column : expected.columns)
+        {
+            codes.append(QString::number(column[row]));
+        }
+        QCOMPARE(lines.at(row).trimmed(), codes.join(" "));
+    }
+}
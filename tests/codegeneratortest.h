@@ -0,0 +1,19 @@
+#ifndef CODEGENERATORTEST_H
+#define CODEGENERATORTEST_H
+
+#include <QObject>
+
+
+class CodeGeneratorTest : public QObject
+{
+    Q_OBJECT
+    
+private slots:
+    // Generated header, compiled by the system compiler, gives the codes of the Interpreter on random Inputs;
+    // names hold characters that are invalid in identifiers and string literals,
+    // or clash with names of the header
+    void sameAsInterpreter();
+    
+};
+
+#endif // CODEGENERATORTEST_H
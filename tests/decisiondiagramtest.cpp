@@ -0,0 +1,76 @@
+#include "decisiondiagramtest.h"
+#include "testdata.h"
+#include "decisiondiagram.h"
+
+#include <QtTest>
+
+
+namespace
+{
+
+// Compares the diagram with the Interpreter on all rows, both through "interpretBatch()" and "interpret()"
+void compareWithInterpreter(const Interpreter &interp, const DecisionDiagram &diagram)
+{
+    TestInputSpace space(interp);
+    
+    TestOutput expected(interp, space.input.rowCount);
+    interp.interpretBatch(space.input, expected.output);
+    TestOutput result(interp, space.input.rowCount);
+    diagram.interpretBatch(space.input, result.output);
+    QVERIFY(result == expected);
+    
+    for (int r = 0; r < space.combinationCount; r++)
+    {
+        QCOMPARE(diagram.interpret(space.row(r)), interp.interpret(space.row(r)));
+    }
+}
+
+}
+
+void DecisionDiagramTest::wholeInputSpace_data()
+{
+    QTest::addColumn<int>("seed");
+    QTest::addColumn<int>("layerCount");
+    QTest::addColumn<int>("valueCount");
+    
+    QTest::newRow("one level") << 1 << 2 << 3;
+    QTest::newRow("several levels") << 2 << 4 << 2;
+    QTest::newRow("wide domains") << 3 << 3 << 5;
+}
+
+void DecisionDiagramTest::wholeInputSpace()
+{
+    QFETCH(int, seed);
+    QFETCH(int, layerCount);
+    QFETCH(int, valueCount);
+    
+    TestProject proj(seed, layerCount, 4, valueCount, 200);
+    Interpreter interp(proj.varNames, proj.varValues, proj.rules);
+    DecisionDiagram diagram(interp);
+    QVERIFY(diagram.isCompiled());
+    QVERIFY(diagram.getNodeCount() > 0);
+    
+    compareWithInterpreter(interp, diagram);
+}
+
+void DecisionDiagramTest::fallback()
+{
+    TestProject proj(4, 3, 4, 3, 200);
+    Interpreter interp(proj.varNames, proj.varValues, proj.rules);
+    
+    DecisionDiagram compiled(interp);
+    QVERIFY(compiled.isCompiled());
+    
+    // Fewer nodes than the Input Variables alone need
+    DecisionDiagram diagram(interp, 2);
+    QVERIFY(!diagram.isCompiled());
+    QCOMPARE(diagram.getNodeCount(), -1);
+    QVERIFY(diagram.getCompileTime() >= 0);
+    
+    compareWithInterpreter(interp, diagram);
+    
+    // Preset Values of assigned Variables bypass the diagram even when it is compiled
+    QMap<QString, QString> input;
+    input.insert(proj.varNames.last(), proj.varValues.last().first());
+    QCOMPARE(compiled.interpret(input), interp.interpret(input));
+}
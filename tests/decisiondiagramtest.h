@@ -0,0 +1,20 @@
+#ifndef DECISIONDIAGRAMTEST_H
+#define DECISIONDIAGRAMTEST_H
+
+#include <QObject>
+
+
+class DecisionDiagramTest : public QObject
+{
+    Q_OBJECT
+    
+private slots:
+    // Every combination of Input Values, unset and out of the domain included
+    void wholeInputSpace_data();
+    void wholeInputSpace();
+    // With more nodes needed than "maxNodes" compiling stops and the Interpreter answers
+    void fallback();
+    
+};
+
+#endif // DECISIONDIAGRAMTEST_H
@@ -0,0 +1,96 @@
+#-------------------------------------------------
+#
+# Tests and benchmarks of the ES IDE core
+#
+#-------------------------------------------------
+
+QT       += core testlib
+QT       -= gui
+
+TARGET = es_tests
+TEMPLATE = app
+
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ..
+
+
+SOURCES += \
+        main.cpp \
+    testdata.cpp \
+    binaryprojectfiletest.cpp \
+    batchexecutortest.cpp \
+    bitsetinterpretertest.cpp \
+    decisiondiagramtest.cpp \
+    interpretgoalstest.cpp \
+    interpretersessiontest.cpp \
+    lookuptabletest.cpp \
+    resultcachetest.cpp \
+    specializationtest.cpp \
+    textprojectparsertest.cpp \
+    projecttest.cpp \
+    ruleoptimizertest.cpp \
+    ruleminimizertest.cpp \
+    codegeneratortest.cpp \
+    ../project.cpp \
+    ../binaryprojectfile.cpp \
+    ../textprojectparser.cpp \
+    ../projectjournal.cpp \
+    ../projectsaver.cpp \
+    ../workstealingpool.cpp \
+    ../batchexecutor.cpp \
+    ../bitsetinterpreter.cpp \
+    ../interpretersession.cpp \
+    ../lookuptable.cpp \
+    ../resultcache.cpp \
+    ../specializationcache.cpp \
+    ../decisiondiagram.cpp \
+    ../ruleoptimizer.cpp \
+    ../ruleminimizer.cpp \
+    ../es_codegen/codegenerator.cpp \
+    ../interpreter.cpp \
+    ../symboltable.cpp \
+    ../ruleprogram.cpp \
+    ../rulegraph.cpp \
+    ../tracer.cpp
+
+HEADERS += \
+        testdata.h \
+    binaryprojectfiletest.h \
+    batchexecutortest.h \
+    bitsetinterpretertest.h \
+    decisiondiagramtest.h \
+    interpretgoalstest.h \
+    interpretersessiontest.h \
+    lookuptabletest.h \
+    resultcachetest.h \
+    specializationtest.h \
+    textprojectparsertest.h \
+    projecttest.h \
+    ruleoptimizertest.h \
+    ruleminimizertest.h \
+    codegeneratortest.h \
+    ../project.h \
+    ../binaryprojectfile.h \
+    ../textprojectparser.h \
+    ../projectjournal.h \
+    ../projectsaver.h \
+    ../workstealingpool.h \
+    ../batchexecutor.h \
+    ../bitsetinterpreter.h \
+    ../interpretersession.h \
+    ../lookuptable.h \
+    ../resultcache.h \
+    ../specializationcache.h \
+    ../decisiondiagram.h \
+    ../ruleoptimizer.h \
+    ../ruleminimizer.h \
+    ../es_codegen/codegenerator.h \
+    ../interpreter.h \
+    ../symboltable.h \
+    ../ruleprogram.h \
+    ../rulegraph.h \
+    ../tracer.h
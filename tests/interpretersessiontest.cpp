@@ -0,0 +1,54 @@
+#include "interpretersessiontest.h"
+#include "testdata.h"
+#include "interpretersession.h"
+
+#include <QtTest>
+
+#include <random>
+
+
+void InterpreterSessionTest::sameAsInterpreter_data()
+{
+    QTest::addColumn<int>("seed");
+    QTest::addColumn<int>("layerCount");
+    QTest::addColumn<int>("ruleCount");
+    
+    QTest::newRow("one level") << 1 << 2 << 50;
+    QTest::newRow("several levels") << 2 << 5 << 400;
+    // Few Values, so many Rules fire and then stop firing again
+    QTest::newRow("dense") << 3 << 4 << 1500;
+}
+
+void InterpreterSessionTest::sameAsInterpreter()
+{
+    QFETCH(int, seed);
+    QFETCH(int, layerCount);
+    QFETCH(int, ruleCount);
+    
+    TestProject proj(seed, layerCount, 6, 3, ruleCount);
+    Interpreter interp(proj.varNames, proj.varValues, proj.rules);
+    const SymbolTable &symbols = interp.getSymbols();
+    const std::vector<int> &inputVarIds = interp.getInputVarIds();
+    
+    TestInput start(interp, 1, seed + 100);
+    QMap<QString, QString> input = start.row(0);
+    InterpreterSession session(interp);
+    session.reset(input);
+    QCOMPARE(session.getOutput(), interp.interpret(input));
+    
+    // One Input at a time, "0" (unset) included; the unchanged Value is tried as well
+    std::mt19937 random(seed);
+    for (int step = 0; step < 2000; step++)
+    {
+        int varId = inputVarIds[random() % inputVarIds.size()];
+        quint32 codeCount = static_cast<quint32>(symbols.getDomainSize(varId)) + 1;
+        quint16 code = static_cast<quint16>(random() % codeCount);
+        
+        QString varName = symbols.getVarName(varId);
+        if (code == 0) input.remove(varName);
+        else input[varName] = symbols.getValueName(varId, code);
+        
+        session.setInput(varId, code);
+        QCOMPARE(session.getOutput(), interp.interpret(input));
+    }
+}
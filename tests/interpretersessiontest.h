@@ -0,0 +1,17 @@
+#ifndef INTERPRETERSESSIONTEST_H
+#define INTERPRETERSESSIONTEST_H
+
+#include <QObject>
+
+
+class InterpreterSessionTest : public QObject
+{
+    Q_OBJECT
+    
+private slots:
+    void sameAsInterpreter_data();
+    void sameAsInterpreter();
+    
+};
+
+#endif // INTERPRETERSESSIONTEST_H
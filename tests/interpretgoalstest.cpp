@@ -0,0 +1,106 @@
+#include "interpretgoalstest.h"
+#include "testdata.h"
+
+#include <QtTest>
+
+#include <random>
+
+
+namespace
+{
+
+Rule makeRule(const QList<Pair> &ifBlock, const QList<Pair> &thenBlock)
+{
+    Rule rule;
+    rule.ifBlock = ifBlock;
+    rule.thenBlock = thenBlock;
+    return rule;
+}
+
+}
+
+void InterpretGoalsTest::sameAsInterpret_data()
+{
+    QTest::addColumn<int>("seed");
+    QTest::addColumn<int>("layerCount");
+    
+    QTest::newRow("one level") << 1 << 2;
+    QTest::newRow("several levels") << 2 << 5;
+    QTest::newRow("deep") << 3 << 8;
+}
+
+void InterpretGoalsTest::sameAsInterpret()
+{
+    QFETCH(int, seed);
+    QFETCH(int, layerCount);
+    
+    TestProject proj(seed, layerCount, 6, 3, 300);
+    Interpreter interp(proj.varNames, proj.varValues, proj.rules);
+    TestInput input(interp, 300, seed + 100);
+    QStringList outputs = interp.getOutputVarList();
+    QStringList inputs = interp.getRequiredInputVarList();
+    
+    std::mt19937 random(seed);
+    for (int r = 0; r < input.input.rowCount; r++)
+    {
+        QMap<QString, QString> row = input.row(r);
+        QMap<QString, QString> expected = interp.interpret(row);
+        
+        // Some Output Variables, every now and then an Input and an unknown name too
+        QStringList goals;
+        for (const QString &var : outputs)
+        {
+            if (random() % 3 == 0) goals.append(var);
+        }
+        if (r % 5 == 0) goals.append(inputs.at(static_cast<int>(random() % inputs.length())));
+        if (r % 7 == 0) goals.append("unknown");
+        
+        QHash<QString, int> fetchCounts;
+        QMap<QString, QString> result = interp.interpretGoals(goals, [&](const QString &var)
+        {
+            fetchCounts[var]++;
+            return row.value(var);
+        });
+        
+        for (auto it = fetchCounts.constBegin(); it != fetchCounts.constEnd(); ++it)
+        {
+            QVERIFY(inputs.contains(it.key()));
+            QCOMPARE(it.value(), 1);
+        }
+        
+        QCOMPARE(result.size(), goals.length() - (r % 7 == 0 ? 1 : 0));
+        for (const QString &goal : goals)
+        {
+            if (goal == "unknown") QVERIFY(!result.contains(goal));
+            else if (inputs.contains(goal)) QCOMPARE(result.value(goal), row.value(goal));
+            else QCOMPARE(result.value(goal), expected.value(goal));
+        }
+    }
+}
+
+void InterpretGoalsTest::skipsNeedlessFetch()
+{
+    // "s" comes from "j"; the last Rule needs "i" only when "s" is "y"
+    QStringList varNames({"i", "j", "s", "o"});
+    QList<QStringList> varValues({{"a", "b"}, {"a", "b"}, {"x", "y"}, {"p"}});
+    QList<Rule> rules({makeRule({Pair("j", "a")}, {Pair("s", "x")}),
+                       makeRule({Pair("j", "b")}, {Pair("s", "y")}),
+                       makeRule({Pair("s", "y"), Pair("i", "a")}, {Pair("o", "p")})});
+    Interpreter interp(varNames, varValues, rules);
+    
+    for (const QString &j : {QString(), QString("a"), QString("b")})
+    {
+        QMap<QString, QString> row({{"i", "a"}});
+        if (!j.isEmpty()) row.insert("j", j);
+        
+        QStringList fetched;
+        QMap<QString, QString> result = interp.interpretGoals({"o"}, [&](const QString &var)
+        {
+            fetched.append(var);
+            return row.value(var);
+        });
+        
+        QCOMPARE(result, interp.interpret(row));
+        QCOMPARE(fetched, (j == "b" ? QStringList({"j", "i"}) : QStringList("j")));
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef INTERPRETGOALSTEST_H
+#define INTERPRETGOALSTEST_H
+
+#include <QObject>
+
+
+class InterpretGoalsTest : public QObject
+{
+    Q_OBJECT
+    
+private slots:
+    // Goals get the Values of "Interpreter::interpret()"; every Input is fetched at most once
+    void sameAsInterpret_data();
+    void sameAsInterpret();
+    // An Input is not fetched when an IF-Pair on a known Value already fails
+    void skipsNeedlessFetch();
+    
+};
+
+#endif // INTERPRETGOALSTEST_H
@@ -0,0 +1,76 @@
+#include "lookuptabletest.h"
+#include "testdata.h"
+#include "lookuptable.h"
+
+#include <QtTest>
+
+
+namespace
+{
+
+// Compares the table with the Interpreter on all rows, both through "interpretBatch()" and "interpret()"
+void compareWithInterpreter(const Interpreter &interp, const LookupTable &table)
+{
+    TestInputSpace space(interp);
+    
+    TestOutput expected(interp, space.input.rowCount);
+    interp.interpretBatch(space.input, expected.output);
+    TestOutput result(interp, space.input.rowCount);
+    table.interpretBatch(space.input, result.output);
+    QVERIFY(result == expected);
+    
+    for (int r = 0; r < space.combinationCount; r++)
+    {
+        QCOMPARE(table.interpret(space.row(r)), interp.interpret(space.row(r)));
+    }
+}
+
+}
+
+void LookupTableTest::wholeInputSpace_data()
+{
+    QTest::addColumn<int>("seed");
+    QTest::addColumn<int>("layerCount");
+    QTest::addColumn<int>("valueCount");
+    
+    QTest::newRow("one level") << 1 << 2 << 3;
+    QTest::newRow("several levels") << 2 << 4 << 2;
+    QTest::newRow("wide domains") << 3 << 3 << 5;
+}
+
+void LookupTableTest::wholeInputSpace()
+{
+    QFETCH(int, seed);
+    QFETCH(int, layerCount);
+    QFETCH(int, valueCount);
+    
+    TestProject proj(seed, layerCount, 4, valueCount, 200);
+    Interpreter interp(proj.varNames, proj.varValues, proj.rules);
+    LookupTable table(interp, 64 * 1024 * 1024, 2);
+    QVERIFY(table.isCompiled());
+    
+    QCOMPARE(table.getEntryCount(), static_cast<qint64>(TestInputSpace(interp).combinationCount));
+    
+    compareWithInterpreter(interp, table);
+}
+
+void LookupTableTest::fallback()
+{
+    TestProject proj(4, 3, 4, 3, 200);
+    Interpreter interp(proj.varNames, proj.varValues, proj.rules);
+    
+    // Room for a single entry of every Output Variable
+    qint64 entryBytes = static_cast<qint64>(interp.getOutputVarIds().size() * sizeof(quint16));
+    LookupTable table(interp, entryBytes);
+    QVERIFY(!table.isCompiled());
+    QCOMPARE(table.getEntryCount(), qint64(-1));
+    
+    compareWithInterpreter(interp, table);
+    
+    // Preset Values of assigned Variables bypass the table even when it is built
+    LookupTable compiled(interp);
+    QVERIFY(compiled.isCompiled());
+    QMap<QString, QString> input;
+    input.insert(proj.varNames.last(), proj.varValues.last().first());
+    QCOMPARE(compiled.interpret(input), interp.interpret(input));
+}
@@ -0,0 +1,20 @@
+#ifndef LOOKUPTABLETEST_H
+#define LOOKUPTABLETEST_H
+
+#include <QObject>
+
+
+class LookupTableTest : public QObject
+{
+    Q_OBJECT
+    
+private slots:
+    // Every combination of Input Values, unset and out of the domain included
+    void wholeInputSpace_data();
+    void wholeInputSpace();
+    // Above the byte limit the table is not built and the Interpreter answers
+    void fallback();
+    
+};
+
+#endif // LOOKUPTABLETEST_H
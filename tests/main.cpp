@@ -0,0 +1,83 @@
+#include "batchexecutortest.h"
+#include "binaryprojectfiletest.h"
+#include "bitsetinterpretertest.h"
+#include "codegeneratortest.h"
+#include "decisiondiagramtest.h"
+#include "interpretgoalstest.h"
+#include "interpretersessiontest.h"
+#include "lookuptabletest.h"
+#include "projecttest.h"
+#include "resultcachetest.h"
+#include "ruleminimizertest.h"
+#include "ruleoptimizertest.h"
+#include "specializationtest.h"
+#include "textprojectparsertest.h"
+
+#include <QCoreApplication>
+#include <QtTest>
+
+// Runs every test class; arguments are passed to each of them, e.g. "-iterations 10" for the benchmarks
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    
+    int status = 0;
+    {
+        BinaryProjectFileTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    {
+        BatchExecutorTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    {
+        BitsetInterpreterTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    {
+        InterpretGoalsTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    {
+        InterpreterSessionTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    {
+        LookupTableTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    {
+        ResultCacheTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    {
+        SpecializationTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    {
+        DecisionDiagramTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    {
+        TextProjectParserTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    {
+        ProjectTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    {
+        RuleOptimizerTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    {
+        RuleMinimizerTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    {
+        CodeGeneratorTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    
+    return status;
+}
@@ -0,0 +1,448 @@
+#include "projecttest.h"
+#include "project.h"
+#include "projectsaver.h"
+
+#include <QtTest>
+
+
+void ProjectTest::initTestCase()
+{
+    QVERIFY(dir.isValid());
+}
+
+void ProjectTest::indicesFollowEdits()
+{
+    Project proj(dir.path(), "indices");
+    QVERIFY(!proj.addVar("a", {"x", "y"}));
+    QVERIFY(!proj.addVar("b", {"x"}));
+    QVERIFY(!proj.addVar("c", {"z"}));
+    QVERIFY(proj.addVar("b", {}).getCode() == ErrorCode::IdentifierAlreadyExists);
+    
+    QVERIFY(!proj.deleteVar("a"));
+    QCOMPARE(*proj.getVarValues("b"), QStringList({"x"}));
+    QCOMPARE(*proj.getVarValues("c"), QStringList({"z"}));
+    QVERIFY(!proj.getVarValues("a"));
+    
+    QVERIFY(!proj.setVarName("a", "c"));
+    QVERIFY(!proj.getVarValues("c"));
+    QCOMPARE(*proj.getVarValues("a"), QStringList({"z"}));
+    
+    QVERIFY(!proj.addVarValue("y", "b"));
+    QVERIFY(proj.addVarValue("y", "b").getCode() == ErrorCode::IdentifierAlreadyExists);
+    QVERIFY(!proj.deleteVarValue("b", "x"));
+    QVERIFY(!proj.setVarValue("x", "b", "y"));
+    QCOMPARE(*proj.getVarValues("b"), QStringList({"x"}));
+    QVERIFY(proj.deleteVarValue("b", "y").getCode() == ErrorCode::UnknownValueName);
+}
+
+void ProjectTest::ruleKeys()
+{
+    // Every Rule has its own Value of "o", so its text tells it apart
+    QStringList values;
+    for (int r = 0; r < 12; r++)
+    {
+        values.append("v" + QString::number(r));
+    }
+    
+    // Checks "getRuleId()" and "getRuleKey()" against each other and the expected Rule order
+    auto checkKeys = [](const Project &proj, const QList<quint64> &keys, const QStringList &texts)
+    {
+        QCOMPARE(proj.getRules().length(), keys.length());
+        for (int r = 0; r < keys.length(); r++)
+        {
+            QVERIFY(keys.at(r) != 0);
+            QCOMPARE(proj.getRuleKey(r), keys.at(r));
+            QCOMPARE(proj.getRuleId(keys.at(r)), r);
+            QCOMPARE(proj.getRuleStringifiedByKey(keys.at(r)), texts.at(r));
+        }
+        QCOMPARE(proj.getRuleKey(keys.length()), quint64(0));
+    };
+    
+    QList<quint64> keys;
+    QStringList texts;
+    QList<quint64> deleted;
+    {
+        Project proj(dir.path(), "keys");
+        QVERIFY(!proj.addVar("i", {"x", "y"}));
+        QVERIFY(!proj.addVar("j", {"x"}));
+        QVERIFY(!proj.addVar("o", values));
+        for (int r = 0; r < 12; r++)
+        {
+            Rule rule;
+            rule.ifBlock = {Pair((r % 4 == 1 ? "j" : "i"), "x")};
+            rule.thenBlock = {Pair("o", values.at(r))};
+            QVERIFY(!proj.addRule(rule));
+            keys.append(proj.getRuleKey());
+            texts.append(proj.getRuleStringified());
+        }
+        checkKeys(proj, keys, texts);
+        
+        // By key, by position, and by a cascade taking Rules "1", "5" and "9"
+        QVERIFY(!proj.deleteRuleByKey(keys.at(3)));
+        deleted.append(keys.takeAt(3));
+        texts.removeAt(3);
+        QVERIFY(!proj.deleteRule(6));
+        deleted.append(keys.takeAt(6));
+        texts.removeAt(6);
+        QVERIFY(!proj.deleteVar("j"));
+        for (int r = keys.length() - 1; r >= 0; r--)
+        {
+            if (!texts.at(r).contains("j")) continue;
+            deleted.append(keys.takeAt(r));
+            texts.removeAt(r);
+        }
+        QCOMPARE(keys.length(), 7);
+        checkKeys(proj, keys, texts);
+        
+        for (quint64 key : deleted)
+        {
+            QVERIFY(!proj.getRuleByKey(key));
+            QCOMPARE(proj.getRuleId(key), -1);
+            QVERIFY(proj.deleteRuleByKey(key));
+        }
+        
+        // Keys of deleted Rules are not given out again
+        Rule rule;
+        rule.ifBlock = {Pair("i", "y")};
+        rule.thenBlock = {Pair("o", "v0")};
+        QVERIFY(!proj.addRule(rule));
+        QVERIFY(!deleted.contains(proj.getRuleKey()));
+        QVERIFY(!keys.contains(proj.getRuleKey()));
+        keys.append(proj.getRuleKey());
+        texts.append(proj.getRuleStringified());
+        
+        // Editing by key after the deletes reaches the same Rule
+        QVERIFY(!proj.addIfPairByKey(Pair("i", "y"), keys.at(2)));
+        texts[2] = proj.getRuleStringifiedByKey(keys.at(2));
+        checkKeys(proj, keys, texts);
+        
+        QVERIFY(proj.commitJournal());
+    }
+    
+    // Every Rule comes from replaying the Journal; keys are new, but consistent and unique
+    Project reopened(dir.filePath("keys/keys.esp"));
+    QList<quint64> reopenedKeys;
+    for (int r = 0; r < reopened.getRules().length(); r++)
+    {
+        QVERIFY(!reopenedKeys.contains(reopened.getRuleKey(r)));
+        reopenedKeys.append(reopened.getRuleKey(r));
+    }
+    checkKeys(reopened, reopenedKeys, texts);
+    
+    QVERIFY(!reopened.deleteRuleByKey(reopenedKeys.at(1)));
+    reopenedKeys.removeAt(1);
+    texts.removeAt(1);
+    checkKeys(reopened, reopenedKeys, texts);
+}
+
+void ProjectTest::cascades()
+{
+    Project proj(dir.path(), "cascades");
+    QVERIFY(!proj.addVar("speed", {"high", "low"}));
+    QVERIFY(!proj.addVar("wind", {"strong", "calm"}));
+    QVERIFY(!proj.addVar("x", {"yes"}));
+    
+    Rule rule;
+    rule.ifBlock = {Pair("speed", "high"), Pair("wind", "strong")};
+    rule.thenBlock = {Pair("x", "yes")};
+    QVERIFY(!proj.addRule(rule));
+    rule.ifBlock = {Pair("wind", "calm")};
+    rule.thenBlock = {Pair("speed", "low"), Pair("x", "yes")};
+    QVERIFY(!proj.addRule(rule));
+    rule.ifBlock = {Pair("wind", "strong")};
+    rule.thenBlock = {Pair("x", "yes")};
+    QVERIFY(!proj.addRule(rule));
+    quint64 first = proj.getRuleKey(0), second = proj.getRuleKey(1), third = proj.getRuleKey(2);
+    
+    QCOMPARE(proj.getVarRuleCount("speed"), 2);
+    QCOMPARE(proj.getValueRuleCount("speed", "high"), 1);
+    QCOMPARE(proj.getValueRuleCount("wind", "strong"), 2);
+    QCOMPARE(proj.getVarRuleCount("x"), 3);
+    
+    QVERIFY(!proj.setVarName("velocity", "speed"));
+    QCOMPARE(proj.getVarRuleCount("speed"), 0);
+    QCOMPARE(proj.getVarRuleCount("velocity"), 2);
+    QVERIFY(proj.getVarRules("velocity").contains(first));
+    QVERIFY(proj.getVarRules("velocity").contains(second));
+    QCOMPARE(proj.getRuleByKey(second)->thenBlock.first(), Pair("velocity", "low"));
+    
+    QVERIFY(!proj.setVarValue("fast", "velocity", "high"));
+    QCOMPARE(proj.getValueRuleCount("velocity", "high"), 0);
+    QCOMPARE(proj.getValueRules("velocity", "fast"), QList<quint64>({first}));
+    QCOMPARE(proj.getRuleByKey(first)->ifBlock.first(), Pair("velocity", "fast"));
+    
+    // Only a THEN-Pair uses the Value, so the Rule stays
+    QVERIFY(!proj.deleteVarValue("velocity", "low"));
+    QCOMPARE(proj.getRules().length(), 3);
+    QCOMPARE(proj.getRuleByKey(second)->thenBlock, QList<Pair>({Pair("x", "yes")}));
+    QCOMPARE(proj.getVarRules("velocity"), QList<quint64>({first}));
+    
+    // The first Rule tests the Variable, so it can never fire any more
+    QVERIFY(!proj.deleteVar("velocity"));
+    QCOMPARE(proj.getRules().length(), 2);
+    QVERIFY(!proj.getRuleByKey(first));
+    QCOMPARE(proj.getRuleId(second), 0);
+    QCOMPARE(proj.getRuleId(third), 1);
+    QCOMPARE(proj.getVarRuleCount("velocity"), 0);
+    QCOMPARE(proj.getValueRuleCount("wind", "strong"), 1);
+    QCOMPARE(proj.getVarRuleCount("x"), 2);
+    
+    // Replaying the Journal repeats the cascades
+    QVERIFY(proj.commitJournal());
+    Project reopened(dir.filePath("cascades/cascades.esp"));
+    QCOMPARE(reopened.getRulezzStringified(), proj.getRulezzStringified());
+    QCOMPARE(reopened.getVarRuleCount("x"), 2);
+}
+
+void ProjectTest::duplicatePairs()
+{
+    Project proj(dir.path(), "duplicates");
+    QVERIFY(!proj.addVar("a", {"x"}));
+    QVERIFY(!proj.addVar("b", {"y"}));
+    QVERIFY(!proj.addRule(Rule()));
+    
+    QVERIFY(!proj.addIfPair(Pair("a", "x")));
+    QVERIFY(proj.addIfPair(Pair("a", "x")).getCode() == ErrorCode::PairAlreadyExists);
+    QVERIFY(!proj.addThenPair(Pair("b", "y")));
+    QVERIFY(proj.addThenPairByKey(Pair("b", "y"), proj.getRuleKey()).getCode() == ErrorCode::PairAlreadyExists);
+    
+    QCOMPARE(proj.getRule()->ifBlock.length(), 1);
+    QCOMPARE(proj.getRule()->thenBlock.length(), 1);
+    
+    // One reference left per Rule, so deleting the Pair frees the Variable
+    QVERIFY(!proj.deleteIfPair());
+    QCOMPARE(proj.getVarRuleCount("a"), 0);
+    QCOMPARE(proj.getValueRuleCount("b", "y"), 1);
+}
+
+void ProjectTest::recreatedProjectIgnoresOldJournal()
+{
+    {
+        Project old(dir.path(), "recreated");
+        QVERIFY(!old.addVar("a", {"x"}));
+        QVERIFY(old.commitJournal());
+    }
+    
+    Project proj(dir.path(), "recreated");
+    QVERIFY(proj.getVarNames().isEmpty());
+    QVERIFY(proj.isSaved());
+    
+    Project reopened(dir.filePath("recreated/recreated.esp"));
+    QVERIFY(reopened.getVarNames().isEmpty());
+}
+
+void ProjectTest::journalRecovery_data()
+{
+    QTest::addColumn<QByteArray>("tail");
+    QTest::addColumn<int>("tornBytes");
+    
+    // Data tags name the Projects
+    QTest::newRow("Uncommitted") << QByteArray() << 0;
+    QTest::newRow("Torn") << QByteArray() << 3;
+    // Header of a Record longer than the rest of the File
+    QTest::newRow("Garbage") << QByteArray("\x13\0\0\0\xab\xcd" "not a record", 18) << 0;
+    QTest::newRow("TornGarbage") << QByteArray(5, '\xff') << 1;
+}
+
+void ProjectTest::journalRecovery()
+{
+    QFETCH(QByteArray, tail);
+    QFETCH(int, tornBytes);
+    
+    QString name = QString("recovery") + QTest::currentDataTag();
+    QString journalPath = dir.filePath(name + "/" + name + ".journal");
+    
+    QStringList varNames;
+    QList<QStringList> varValues;
+    QStringList rules;
+    qint64 committedSize;
+    {
+        // Every Operation once
+        Project proj(dir.path(), name);
+        QVERIFY(!proj.addVar("a", {"x", "y"}));
+        QVERIFY(!proj.addVar("b", {"p"}));
+        QVERIFY(!proj.addVar("c", {"q"}));
+        QVERIFY(!proj.addVar("e", {"r", "s"}));
+        QVERIFY(!proj.addVarValue("z", "a"));
+        QVERIFY(!proj.setVarValue("w", "a", "y"));
+        QVERIFY(!proj.deleteVarValue("a", "x"));
+        QVERIFY(!proj.setVarName("d", "c"));
+        QVERIFY(!proj.deleteVar("b"));
+        
+        Rule rule;
+        rule.ifBlock = {Pair("a", "w")};
+        rule.thenBlock = {Pair("d", "q")};
+        QVERIFY(!proj.addRule(rule));
+        QVERIFY(!proj.addIfPair(Pair("e", "r")));
+        QVERIFY(!proj.addThenPair(Pair("e", "s")));
+        QVERIFY(!proj.addRule(rule));
+        QVERIFY(!proj.deleteRule());
+        rule.ifBlock = {Pair("a", "z"), Pair("e", "s")};
+        rule.thenBlock = {Pair("d", "q"), Pair("e", "r")};
+        QVERIFY(!proj.addRule(rule));
+        QVERIFY(!proj.deleteIfPair());
+        QVERIFY(!proj.deleteThenPair());
+        QVERIFY(proj.commitJournal());
+        
+        varNames = proj.getVarNames();
+        varValues = proj.getAllVarValues();
+        rules = proj.getRulezzStringified();
+        committedSize = QFileInfo(journalPath).size();
+        QVERIFY(committedSize > 0);
+        
+        // Never committed
+        QVERIFY(!proj.addVar("f", {"t"}));
+        QVERIFY(!proj.setVarName("g", "d"));
+        QVERIFY(!proj.deleteRule(0));
+        QVERIFY(!proj.addRule(rule));
+    }
+    
+    QFile journalFile(journalPath);
+    QVERIFY(journalFile.size() > committedSize);
+    QVERIFY(journalFile.open(QFile::ReadWrite));
+    QVERIFY(journalFile.resize(journalFile.size() - tornBytes));
+    QVERIFY(journalFile.seek(journalFile.size()));
+    QCOMPARE(journalFile.write(tail), static_cast<qint64>(tail.size()));
+    journalFile.close();
+    
+    {
+        Project reopened(dir.filePath(name + "/" + name + ".esp"));
+        QVERIFY(!reopened.getLoadError());
+        QVERIFY(reopened.isSaved());
+        QCOMPARE(reopened.getVarNames(), varNames);
+        QCOMPARE(reopened.getAllVarValues(), varValues);
+        QCOMPARE(reopened.getRulezzStringified(), rules);
+        QCOMPARE(QFileInfo(journalPath).size(), committedSize);
+        
+        // Records appended after the cut are found again
+        QVERIFY(!reopened.addVar("h", {"u"}));
+        QVERIFY(reopened.commitJournal());
+    }
+    
+    Project again(dir.filePath(name + "/" + name + ".esp"));
+    QCOMPARE(again.getVarNames(), varNames + QStringList("h"));
+    QCOMPARE(again.getRulezzStringified(), rules);
+}
+
+void ProjectTest::snapshotDuringEdits()
+{
+    QDir folder(dir.filePath("snapshot"));
+    QStringList varNames;
+    QStringList rules;
+    {
+        Project proj(dir.path(), "snapshot");
+        QVERIFY(!proj.addVar("a", {"x", "y"}));
+        QVERIFY(!proj.addVar("b", {"z"}));
+        QVERIFY(proj.commitJournal());
+        
+        ProjectSaver saver;
+        quint64 savedRevision = 0;
+        bool savedOk = false;
+        connect(&saver, &ProjectSaver::finished, [&](quint64 revision, bool ok)
+        {
+            savedRevision = revision;
+            savedOk = ok;
+            proj.setSnapshotSaved(revision);
+        });
+        
+        ProjectSnapshot snapshot = proj.snapshot();
+        saver.save(snapshot);
+        
+        // The saver thread may still be writing
+        Rule rule;
+        rule.ifBlock = {Pair("a", "x")};
+        rule.thenBlock = {Pair("b", "z")};
+        QVERIFY(!proj.addRule(rule));
+        QVERIFY(!proj.setVarName("c", "b"));
+        QVERIFY(!proj.addVar("d", {"w"}));
+        
+        saver.wait();
+        QVERIFY(savedOk);
+        QCOMPARE(savedRevision, snapshot.getRevision());
+        QVERIFY(!proj.isSaved());
+        QVERIFY(folder.exists("snapshot." + QString::number(savedRevision) + ".var"));
+        
+        // Only the Records older than the snapshot could be dropped
+        QVERIFY(proj.commitJournal());
+        QVERIFY(proj.isSaved());
+        varNames = proj.getVarNames();
+        rules = proj.getRulezzStringified();
+    }
+    
+    Project reopened(folder.filePath("snapshot.esp"));
+    QVERIFY(!reopened.getLoadError());
+    QCOMPARE(reopened.getVarNames(), varNames);
+    QCOMPARE(reopened.getVarNames(), QStringList({"a", "c", "d"}));
+    QCOMPARE(reopened.getRulezzStringified(), rules);
+}
+
+void ProjectTest::compactSwitchesFiles()
+{
+    QDir folder(dir.filePath("compacted"));
+    {
+        Project proj(dir.path(), "compacted");
+        QVERIFY(!proj.addVar("a", {"x"}));
+        QVERIFY(!proj.compact());
+        QVERIFY(!folder.exists("compacted.var"));
+        QVERIFY(folder.exists("compacted.1.var"));
+        QVERIFY(folder.exists("compacted.1.rul"));
+        
+        QVERIFY(!proj.addVar("b", {"y"}));
+        QVERIFY(!proj.compact());
+        QVERIFY(!folder.exists("compacted.1.var"));
+        QVERIFY(folder.exists("compacted.2.var"));
+        
+        // Nothing to write, the Files stay
+        QVERIFY(!proj.compact());
+        QVERIFY(folder.exists("compacted.2.var"));
+    }
+    
+    QVERIFY(QFile::remove(folder.filePath("compacted.journal")));
+    Project reopened(folder.filePath("compacted.esp"));
+    QVERIFY(!reopened.getLoadError());
+    QCOMPARE(reopened.getVarNames(), QStringList({"a", "b"}));
+}
+
+void ProjectTest::addVarsSpeed()
+{
+    Project proj(dir.path(), "vars");
+    QStringList values({"v0", "v1", "v2", "v3"});
+    
+    QBENCHMARK_ONCE
+    {
+        for (int i = 0; i < 100000; i++)
+        {
+            proj.addVar("x" + QString::number(i), values);
+        }
+        // Every name is looked up once more
+        for (int i = 0; i < 100000; i++)
+        {
+            proj.addVarValue("v4", "x" + QString::number(i));
+        }
+    }
+    
+    QCOMPARE(proj.getVarNames().length(), 100000);
+    QCOMPARE(proj.getVarValues("x99999")->length(), 5);
+}
+
+void ProjectTest::addRulesSpeed()
+{
+    Project proj(dir.path(), "rules");
+    for (int i = 0; i < 100; i++)
+    {
+        proj.addVar("x" + QString::number(i), {"v0", "v1"});
+    }
+    
+    QBENCHMARK_ONCE
+    {
+        for (int r = 0; r < 1000000; r++)
+        {
+            Rule rule;
+            rule.ifBlock.append(Pair("x" + QString::number(r % 50), "v" + QString::number(r % 2)));
+            rule.thenBlock.append(Pair("x" + QString::number(50 + r % 50), "v" + QString::number(r / 2 % 2)));
+            proj.addRule(rule);
+        }
+    }
+    
+    QCOMPARE(proj.getRules().length(), 1000000);
+}
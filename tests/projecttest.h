@@ -0,0 +1,41 @@
+#ifndef PROJECTTEST_H
+#define PROJECTTEST_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+
+class ProjectTest : public QObject
+{
+    Q_OBJECT
+    
+private slots:
+    void initTestCase();
+    
+    // Name lookups still find the right ids after renames and deletes
+    void indicesFollowEdits();
+    // Rule keys and their positions stay right after deletes in the middle and after Journal replay
+    void ruleKeys();
+    // Renames follow into the Rules; deletes drop THEN-Pairs and the Rules whose IF-Pairs can not hold any more
+    void cascades();
+    // A Pair already in the block is refused and not referenced twice
+    void duplicatePairs();
+    // Committed edits of a Project do not show up in a new Project created in its place
+    void recreatedProjectIgnoresOldJournal();
+    // Reopening after a crash replays exactly the committed edits of every kind and cuts off the rest of the Journal
+    void journalRecovery_data();
+    void journalRecovery();
+    // Edits made while a snapshot is written keep the Project unsaved and are kept by the Journal
+    void snapshotDuringEdits();
+    // Compaction moves the Text Project to new ".var" and ".rul" Files and removes the old ones
+    void compactSwitchesFiles();
+    // 100k Variables and 1M Rules added through the Project API
+    void addVarsSpeed();
+    void addRulesSpeed();
+    
+private:
+    QTemporaryDir dir;
+    
+};
+
+#endif // PROJECTTEST_H
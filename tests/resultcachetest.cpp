@@ -0,0 +1,141 @@
+#include "resultcachetest.h"
+#include "testdata.h"
+#include "resultcache.h"
+
+#include <QtTest>
+
+
+namespace
+{
+
+Rule makeRule(const QList<Pair> &ifBlock, const QList<Pair> &thenBlock)
+{
+    Rule rule;
+    rule.ifBlock = ifBlock;
+    rule.thenBlock = thenBlock;
+    return rule;
+}
+
+}
+
+void ResultCacheTest::hitsMissesEvictions()
+{
+    Interpreter interp({"a", "b", "o"}, {{"x", "y"}, {"x", "y"}, {"p", "q"}},
+                       {makeRule({Pair("a", "x"), Pair("b", "y")}, {Pair("o", "p")}), makeRule({Pair("b", "x")}, {Pair("o", "q")})});
+    QCOMPARE(interp.getRequiredInputVarList().length(), 2);
+    
+    // Keys "k[0] ... k[5]" are all different
+    std::vector<std::vector<quint16>> k{{0, 0}, {1, 0}, {2, 0}, {0, 1}, {1, 1}, {2, 2}};
+    auto expected = [&](const std::vector<quint16> &key)
+    {
+        Interpreter::BatchInput input;
+        input.rowCount = 1;
+        for (const quint16 &code : key)
+        {
+            input.columns.push_back(&code);
+        }
+        std::vector<quint16> result(1, 0);
+        Interpreter::BatchOutput output;
+        output.columns.push_back(result.data());
+        interp.interpretBatch(input, output);
+        return result;
+    };
+    
+    ResultCache cache(4, 1);
+    std::vector<quint16> output;
+    for (int i = 0; i < 4; i++)
+    {
+        cache.interpret(interp, k[i], output);
+        QVERIFY(output == expected(k[i]));
+    }
+    QCOMPARE(cache.getMissCount(), quint64(4));
+    QCOMPARE(cache.getHitCount(), quint64(0));
+    QCOMPARE(cache.getEvictionCount(), quint64(0));
+    
+    cache.interpret(interp, k[0], output);
+    QVERIFY(output == expected(k[0]));
+    QCOMPARE(cache.getHitCount(), quint64(1));
+    
+    // "k[0]" was just used, so the clock passes it over and evicts "k[1]", then "k[2]"
+    cache.interpret(interp, k[4], output);
+    QCOMPARE(cache.getEvictionCount(), quint64(1));
+    cache.interpret(interp, k[1], output);
+    QVERIFY(output == expected(k[1]));
+    QCOMPARE(cache.getMissCount(), quint64(6));
+    QCOMPARE(cache.getEvictionCount(), quint64(2));
+    
+    cache.interpret(interp, k[0], output);
+    cache.interpret(interp, k[3], output);
+    QCOMPARE(cache.getHitCount(), quint64(3));
+    // "k[3]" and "k[0]" lose their second chance, "k[4]" goes
+    cache.interpret(interp, k[2], output);
+    QVERIFY(output == expected(k[2]));
+    QCOMPARE(cache.getMissCount(), quint64(7));
+    QCOMPARE(cache.getEvictionCount(), quint64(3));
+    
+    cache.clear();
+    cache.interpret(interp, k[0], output);
+    QCOMPARE(cache.getMissCount(), quint64(8));
+}
+
+void ResultCacheTest::sameAsInterpreter()
+{
+    TestProject proj(1, 3, 4, 3, 200);
+    Interpreter interp(proj.varNames, proj.varValues, proj.rules);
+    TestInput input(interp, 3000, 2);
+    
+    ResultCache cache(64, 4);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (int r = 0; r < input.input.rowCount; r++)
+        {
+            QCOMPARE(cache.interpret(interp, input.row(r)), interp.interpret(input.row(r)));
+        }
+    }
+    QVERIFY(cache.getHitCount() > 0);
+    QVERIFY(cache.getEvictionCount() > 0);
+    QCOMPARE(cache.getHitCount() + cache.getMissCount(), quint64(2 * input.input.rowCount));
+}
+
+void ResultCacheTest::sharedBetweenInterpreters()
+{
+    // Same Variables and Inputs, so only the fingerprint tells the keys apart
+    QStringList varNames({"a", "o"});
+    QList<QStringList> varValues({{"x", "y"}, {"p", "q"}});
+    Interpreter first(varNames, varValues, {makeRule({Pair("a", "x")}, {Pair("o", "p")})});
+    Interpreter second(varNames, varValues, {makeRule({Pair("a", "x")}, {Pair("o", "q")})});
+    Interpreter firstAgain(varNames, varValues, {makeRule({Pair("a", "x")}, {Pair("o", "p")})});
+    QVERIFY(first.getFingerprint() != second.getFingerprint());
+    QCOMPARE(firstAgain.getFingerprint(), first.getFingerprint());
+    
+    QMap<QString, QString> input({{"a", "x"}});
+    QMap<QString, QString> firstOutput({{"o", "p"}});
+    QMap<QString, QString> secondOutput({{"o", "q"}});
+    
+    ResultCache cache;
+    for (int pass = 0; pass < 3; pass++)
+    {
+        QCOMPARE(cache.interpret(first, input), firstOutput);
+        QCOMPARE(cache.interpret(second, input), secondOutput);
+    }
+    QCOMPARE(cache.getMissCount(), quint64(2));
+    QCOMPARE(cache.getHitCount(), quint64(4));
+    
+    // Equal Interpreters share their entries
+    QCOMPARE(cache.interpret(firstAgain, input), firstOutput);
+    QCOMPARE(cache.getHitCount(), quint64(5));
+    
+    // Many keys of both in a few shards
+    TestProject proj(3, 2, 4, 3, 100);
+    TestProject otherProj(4, 2, 4, 3, 100);
+    Interpreter interp(proj.varNames, proj.varValues, proj.rules);
+    Interpreter otherInterp(otherProj.varNames, otherProj.varValues, otherProj.rules);
+    TestInput rows(interp, 500, 5);
+    TestInput otherRows(otherInterp, 500, 5);
+    ResultCache smallCache(256, 2);
+    for (int r = 0; r < 500; r++)
+    {
+        QCOMPARE(smallCache.interpret(interp, rows.row(r)), interp.interpret(rows.row(r)));
+        QCOMPARE(smallCache.interpret(otherInterp, otherRows.row(r)), otherInterp.interpret(otherRows.row(r)));
+    }
+}
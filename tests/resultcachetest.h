@@ -0,0 +1,21 @@
+#ifndef RESULTCACHETEST_H
+#define RESULTCACHETEST_H
+
+#include <QObject>
+
+
+class ResultCacheTest : public QObject
+{
+    Q_OBJECT
+    
+private slots:
+    // Counters and CLOCK eviction of a single small shard
+    void hitsMissesEvictions();
+    // Results stay right while a small cache keeps evicting
+    void sameAsInterpreter();
+    // Interpreters with different Rules never get results of each other from a shared cache
+    void sharedBetweenInterpreters();
+    
+};
+
+#endif // RESULTCACHETEST_H
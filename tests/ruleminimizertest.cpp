@@ -0,0 +1,112 @@
+#include "ruleminimizertest.h"
+#include "testdata.h"
+#include "ruleminimizer.h"
+
+#include <QtTest>
+
+
+namespace
+{
+
+Rule makeRule(const QList<Pair> &ifBlock, const QList<Pair> &thenBlock)
+{
+    Rule rule;
+    rule.ifBlock = ifBlock;
+    rule.thenBlock = thenBlock;
+    return rule;
+}
+    
+}
+
+void RuleMinimizerTest::keepsInputFamily()
+{
+    QStringList varNames({"i", "o"});
+    QList<QStringList> varValues({{"a", "b"}, {"x"}});
+    QList<Rule> rules({makeRule({Pair("i", "a")}, {Pair("o", "x")}),
+                       makeRule({Pair("i", "b")}, {Pair("o", "x")})});
+    
+    RuleMinimizer minimizer(varNames, varValues, rules);
+    QCOMPARE(minimizer.getMergeCount(), 0);
+    QCOMPARE(minimizer.getRules().length(), 2);
+}
+
+void RuleMinimizerTest::mergesAssignedFamily()
+{
+    QStringList varNames({"i", "s", "t", "o"});
+    QList<QStringList> varValues({{"a", "b"}, {"a", "b"}, {"y", "z"}, {"x"}});
+    // "s" is "a" unless "i" is "b", so it is never unset when the family is evaluated
+    QList<Rule> rules({makeRule({}, {Pair("s", "a")}),
+                       makeRule({Pair("i", "b")}, {Pair("s", "b")}),
+                       makeRule({}, {Pair("t", "y")}),
+                       makeRule({Pair("s", "a"), Pair("t", "y")}, {Pair("o", "x")}),
+                       makeRule({Pair("s", "b"), Pair("t", "y")}, {Pair("o", "x")})});
+    
+    RuleMinimizer minimizer(varNames, varValues, rules);
+    QCOMPARE(minimizer.getMergeCount(), 1);
+    QCOMPARE(minimizer.getRules().length(), 4);
+    QCOMPARE(minimizer.getRuleSources().at(3), QList<int>({3, 4}));
+    
+    Interpreter source(varNames, varValues, rules);
+    Interpreter minimized(varNames, varValues, minimizer.getRules());
+    for (const QString &value : {QString(), QString("a"), QString("b")})
+    {
+        QMap<QString, QString> input;
+        if (!value.isNull()) input.insert("i", value);
+        QCOMPARE(minimized.interpret(input), source.interpret(input));
+    }
+}
+
+void RuleMinimizerTest::sameResults()
+{
+    for (quint32 seed = 1; seed <= 20; seed++)
+    {
+        TestProject proj(seed, 3, 3, 2, 40);
+        
+        // Families: the first Rules once more with every other Value of their first IF-Variable
+        int familyCount = proj.rules.length() / 2;
+        for (int r = 0; r < familyCount; r++)
+        {
+            Rule rule = proj.rules.at(r);
+            const QStringList &domain = proj.varValues.at(proj.varNames.indexOf(rule.ifBlock.first().var));
+            for (const QString &value : domain)
+            {
+                if (value == proj.rules.at(r).ifBlock.first().value) continue;
+                rule.ifBlock.first().value = value;
+                proj.rules.append(rule);
+            }
+        }
+        
+        RuleMinimizer minimizer(proj.varNames, proj.varValues, proj.rules);
+        
+        Interpreter source(proj.varNames, proj.varValues, proj.rules);
+        Interpreter minimized(proj.varNames, proj.varValues, minimizer.getRules());
+        QCOMPARE(minimized.getRequiredInputVarList(), source.getRequiredInputVarList());
+        QCOMPARE(minimized.getOutputVarList(), source.getOutputVarList());
+        
+        // Every combination of declared Values of the Input Variables; digit "0" leaves the Variable unset
+        const QStringList &inputVars = source.getRequiredInputVarList();
+        QList<int> digits;
+        for (int k = 0; k < inputVars.length(); k++)
+        {
+            digits.append(0);
+        }
+        for (;;)
+        {
+            QMap<QString, QString> input;
+            for (int k = 0; k < inputVars.length(); k++)
+            {
+                if (digits.at(k) == 0) continue;
+                input[inputVars.at(k)] = proj.varValues.at(proj.varNames.indexOf(inputVars.at(k))).at(digits.at(k) - 1);
+            }
+            QCOMPARE(minimized.interpret(input), source.interpret(input));
+            
+            int k = 0;
+            for (; k < digits.length(); k++)
+            {
+                if (++digits[k] <= proj.varValues.at(proj.varNames.indexOf(inputVars.at(k))).length()) break;
+                digits[k] = 0;
+            }
+            if (k == digits.length()) break;
+        }
+    }
+}
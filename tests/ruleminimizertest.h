@@ -0,0 +1,21 @@
+#ifndef RULEMINIMIZERTEST_H
+#define RULEMINIMIZERTEST_H
+
+#include <QObject>
+
+
+class RuleMinimizerTest : public QObject
+{
+    Q_OBJECT
+    
+private slots:
+    // A family on an Input Variable stays, since the Input may be unset
+    void keepsInputFamily();
+    // A family on a Variable that is always assigned before it is merged
+    void mergesAssignedFamily();
+    // Minimized Rules give the same results for every Input, unset ones included, of random Projects with whole families
+    void sameResults();
+    
+};
+
+#endif // RULEMINIMIZERTEST_H
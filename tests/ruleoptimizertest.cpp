@@ -0,0 +1,56 @@
+#include "ruleoptimizertest.h"
+#include "testdata.h"
+#include "ruleoptimizer.h"
+
+#include <QtTest>
+
+
+void RuleOptimizerTest::singleReaderInput()
+{
+    QStringList varNames({"i", "j", "o"});
+    QList<QStringList> varValues({{"a", "b"}, {"a", "b"}, {"x"}});
+    
+    QList<Rule> rules;
+    Rule rule;
+    rule.ifBlock = {Pair("j", "a")};
+    rule.thenBlock = {Pair("o", "x")};
+    rules.append(rule);
+    // Contradicted, and the only Rule reading "i"
+    rule.ifBlock = {Pair("i", "a"), Pair("i", "b")};
+    rules.append(rule);
+    // Contradicted, but "j" is read by the first Rule too
+    rule.ifBlock = {Pair("j", "a"), Pair("j", "b")};
+    rules.append(rule);
+    
+    RuleOptimizer optimizer(varNames, varValues, rules);
+    
+    QCOMPARE(optimizer.getRuleSource(), QList<int>({0, 1}));
+    QCOMPARE(optimizer.getRemovedRules().length(), 1);
+    QCOMPARE(optimizer.getRemovedRules().at(0).ruleId, 2);
+    QVERIFY(optimizer.getRemovedRules().at(0).reason == RuleOptimizer::Reason::Contradiction);
+    
+    Interpreter source(varNames, varValues, rules);
+    Interpreter optimized(varNames, varValues, optimizer.getRules());
+    QCOMPARE(optimized.getRequiredInputVarList(), source.getRequiredInputVarList());
+}
+
+void RuleOptimizerTest::sameResults()
+{
+    for (quint32 seed = 1; seed <= 20; seed++)
+    {
+        TestProject proj(seed, 3, 4, 3, 200);
+        Interpreter source(proj.varNames, proj.varValues, proj.rules);
+        RuleOptimizer optimizer(proj.varNames, proj.varValues, proj.rules);
+        Interpreter optimized(proj.varNames, proj.varValues, optimizer.getRules());
+        
+        QCOMPARE(optimized.getRequiredInputVarList(), source.getRequiredInputVarList());
+        QCOMPARE(optimized.getOutputVarList(), source.getOutputVarList());
+        
+        TestInput input(source, 2000, seed + 100);
+        TestOutput expected(source, input.input.rowCount);
+        source.interpretBatch(input.input, expected.output);
+        TestOutput result(optimized, input.input.rowCount);
+        optimized.interpretBatch(input.input, result.output);
+        QVERIFY(result == expected);
+    }
+}
@@ -0,0 +1,19 @@
+#ifndef RULEOPTIMIZERTEST_H
+#define RULEOPTIMIZERTEST_H
+
+#include <QObject>
+
+
+class RuleOptimizerTest : public QObject
+{
+    Q_OBJECT
+    
+private slots:
+    // A removed Rule that is the only reader of an Input Variable is put back, other removals stay
+    void singleReaderInput();
+    // Optimized Rules give the same results on random Projects
+    void sameResults();
+    
+};
+
+#endif // RULEOPTIMIZERTEST_H
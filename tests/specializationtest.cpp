@@ -0,0 +1,108 @@
+#include "specializationtest.h"
+#include "testdata.h"
+#include "specializationcache.h"
+
+#include <QtTest>
+
+#include <random>
+
+
+void SpecializationTest::residualMatchesBase_data()
+{
+    QTest::addColumn<int>("seed");
+    QTest::addColumn<int>("layerCount");
+    
+    QTest::newRow("one level") << 1 << 2;
+    QTest::newRow("several levels") << 2 << 5;
+    QTest::newRow("other pins") << 3 << 4;
+}
+
+void SpecializationTest::residualMatchesBase()
+{
+    QFETCH(int, seed);
+    QFETCH(int, layerCount);
+    
+    TestProject proj(seed, layerCount, 6, 3, 400);
+    Interpreter base(proj.varNames, proj.varValues, proj.rules);
+    const SymbolTable &symbols = base.getSymbols();
+    
+    // First Input and about a third of the others, some of them pinned to unset
+    std::mt19937 random(seed);
+    QMap<QString, QString> pinned;
+    QStringList freeInputs;
+    for (int varId : base.getInputVarIds())
+    {
+        if (random() % 3 != 0 && !pinned.isEmpty())
+        {
+            freeInputs.append(symbols.getVarName(varId));
+            continue;
+        }
+        quint16 code = static_cast<quint16>(random() % (symbols.getDomainSize(varId) + 1));
+        pinned.insert(symbols.getVarName(varId), symbols.getValueName(varId, code));
+    }
+    
+    Interpreter residual = base.specialize(pinned);
+    QCOMPARE(residual.getRequiredInputVarList(), freeInputs);
+    QCOMPARE(residual.getOutputVarList(), base.getOutputVarList());
+    QVERIFY(residual.getProgram().getRuleCount() <= base.getProgram().getRuleCount());
+    
+    TestInput input(base, 1000, seed + 100);
+    for (int r = 0; r < input.input.rowCount; r++)
+    {
+        QMap<QString, QString> row = input.row(r);
+        for (const QString &var : pinned.keys())
+        {
+            row.remove(var);
+        }
+        
+        QMap<QString, QString> full = row;
+        for (auto it = pinned.constBegin(); it != pinned.constEnd(); ++it)
+        {
+            if (!it.value().isEmpty()) full.insert(it.key(), it.value());
+        }
+        QCOMPARE(residual.interpret(row), base.interpret(full));
+    }
+}
+
+void SpecializationTest::cacheReuseAndEviction()
+{
+    TestProject proj(4, 3, 4, 3, 200);
+    Interpreter base(proj.varNames, proj.varValues, proj.rules);
+    QStringList inputs = base.getRequiredInputVarList();
+    QVERIFY(inputs.length() >= 2);
+    
+    QMap<QString, QString> a({{inputs.at(0), "v0"}});
+    QMap<QString, QString> b({{inputs.at(0), "v1"}});
+    QMap<QString, QString> c({{inputs.at(0), "v0"}, {inputs.at(1), "v2"}});
+    
+    SpecializationCache cache(base, 2);
+    std::shared_ptr<const Interpreter> first = cache.get(a);
+    QCOMPARE(first->getFingerprint(), base.specialize(a).getFingerprint());
+    QVERIFY(cache.get(a) == first);
+    // Pins of Variables that are no Inputs are not part of the key
+    QMap<QString, QString> aWithOutput = a;
+    aWithOutput.insert(base.getOutputVarList().first(), "v0");
+    QVERIFY(cache.get(aWithOutput) == first);
+    QCOMPARE(cache.getSize(), 1);
+    
+    std::shared_ptr<const Interpreter> second = cache.get(b);
+    QVERIFY(second != first);
+    QCOMPARE(cache.getSize(), 2);
+    
+    // First in, first out, even though "a" was asked for last
+    QVERIFY(cache.get(a) == first);
+    std::shared_ptr<const Interpreter> third = cache.get(c);
+    QCOMPARE(cache.getSize(), 2);
+    QVERIFY(cache.get(b) == second);
+    QVERIFY(cache.get(c) == third);
+    
+    // Dropped Interpreter stays usable by its holders and is made again on request
+    std::shared_ptr<const Interpreter> firstAgain = cache.get(a);
+    QVERIFY(firstAgain != first);
+    QCOMPARE(firstAgain->getFingerprint(), first->getFingerprint());
+    QCOMPARE(first->interpret(QMap<QString, QString>()), base.interpret(a));
+    QCOMPARE(cache.getSize(), 2);
+    
+    // "b" was the oldest now
+    QVERIFY(cache.get(b) != second);
+}
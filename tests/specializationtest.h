@@ -0,0 +1,20 @@
+#ifndef SPECIALIZATIONTEST_H
+#define SPECIALIZATIONTEST_H
+
+#include <QObject>
+
+
+class SpecializationTest : public QObject
+{
+    Q_OBJECT
+    
+private slots:
+    // Residual Interpreter gives the results of the base one with the pinned Inputs added
+    void residualMatchesBase_data();
+    void residualMatchesBase();
+    // Equal pins get the same Interpreter; the oldest one is dropped when the cache is full
+    void cacheReuseAndEviction();
+    
+};
+
+#endif // SPECIALIZATIONTEST_H
@@ -0,0 +1,176 @@
+#include "testdata.h"
+
+#include <QFile>
+#include <QTextStream>
+
+#include <random>
+
+
+TestProject::TestProject(quint32 seed, int layerCount, int varsPerLayer, int valueCount, int ruleCount)
+{
+    std::mt19937 random(seed);
+    
+    for (int l = 0; l < layerCount; l++)
+    {
+        for (int i = 0; i < varsPerLayer; i++)
+        {
+            varNames.append("x" + QString::number(l) + "_" + QString::number(i));
+            QStringList values;
+            for (int v = 0; v < valueCount; v++)
+            {
+                values.append("v" + QString::number(v));
+            }
+            varValues.append(values);
+        }
+    }
+    
+    auto pick = [&](int first, int count) { return first + static_cast<int>(random() % static_cast<quint32>(count)); };
+    auto pair = [&](int varId) { return Pair(varNames.at(varId), varValues.at(varId).at(pick(0, valueCount))); };
+    
+    for (int r = 0; r < ruleCount; r++)
+    {
+        Rule rule;
+        int layer = pick(1, layerCount - 1);
+        
+        int ifCount = pick(1, 3);
+        for (int i = 0; i < ifCount; i++)
+        {
+            rule.ifBlock.append(pair(pick(0, layer * varsPerLayer)));
+        }
+        int thenCount = pick(1, 2);
+        for (int i = 0; i < thenCount; i++)
+        {
+            rule.thenBlock.append(pair(pick(layer * varsPerLayer, varsPerLayer)));
+        }
+        
+        rules.append(rule);
+    }
+}
+
+bool TestProject::writeText(const QString &varFilePath, const QString &rulFilePath) const
+{
+    QFile varFile(varFilePath);
+    if (!varFile.open(QFile::WriteOnly | QFile::Truncate)) return false;
+    QTextStream varFileStream(&varFile);
+    for (int i = 0; i < varNames.length(); i++)
+    {
+        varFileStream << (QStringList(varNames.at(i)) + varValues.at(i)).join(".") << "\n";
+    }
+    varFileStream.flush();
+    
+    QFile rulFile(rulFilePath);
+    if (!rulFile.open(QFile::WriteOnly | QFile::Truncate)) return false;
+    QTextStream rulFileStream(&rulFile);
+    for (const Rule &rule : rules)
+    {
+        QStringList ifPairs, thenPairs;
+        for (const Pair &ifPair : rule.ifBlock)
+        {
+            ifPairs.append(ifPair.var + "=" + ifPair.value);
+        }
+        for (const Pair &thenPair : rule.thenBlock)
+        {
+            thenPairs.append(thenPair.var + "=" + thenPair.value);
+        }
+        rulFileStream << ifPairs.join("&") << "-" << thenPairs.join("&") << "\n";
+    }
+    rulFileStream.flush();
+    
+    return (varFileStream.status() == QTextStream::Ok && rulFileStream.status() == QTextStream::Ok);
+}
+
+TestInput::TestInput(const Interpreter &interp, int rowCount, quint32 seed) :
+    interp(interp)
+{
+    std::mt19937 random(seed);
+    const SymbolTable &symbols = interp.getSymbols();
+    
+    input.rowCount = rowCount;
+    for (int varId : interp.getInputVarIds())
+    {
+        quint32 codeCount = static_cast<quint32>(symbols.getDomainSize(varId)) + 1;
+        std::vector<quint16> column(rowCount);
+        for (quint16 &code : column)
+        {
+            code = static_cast<quint16>(random() % codeCount);
+        }
+        columns.push_back(column);
+    }
+    for (const std::vector<quint16> &column : columns)
+    {
+        input.columns.push_back(column.data());
+    }
+}
+
+QMap<QString, QString> TestInput::row(int r) const
+{
+    const SymbolTable &symbols = interp.getSymbols();
+    const std::vector<int> &inputVarIds = interp.getInputVarIds();
+    
+    QMap<QString, QString> result;
+    for (size_t k = 0; k < inputVarIds.size(); k++)
+    {
+        quint16 code = columns[k][r];
+        if (code != 0) result.insert(symbols.getVarName(inputVarIds[k]), symbols.getValueName(inputVarIds[k], code));
+    }
+    return result;
+}
+
+TestInputSpace::TestInputSpace(const Interpreter &interp) :
+    interp(interp),
+    combinationCount(1)
+{
+    const SymbolTable &symbols = interp.getSymbols();
+    const std::vector<int> &inputVarIds = interp.getInputVarIds();
+    int inputCount = static_cast<int>(inputVarIds.size());
+    
+    for (int varId : inputVarIds)
+    {
+        combinationCount *= symbols.getDomainSize(varId) + 1;
+    }
+    
+    input.rowCount = combinationCount + inputCount;
+    columns.assign(inputCount, std::vector<quint16>(input.rowCount, 0));
+    for (int row = 0; row < combinationCount; row++)
+    {
+        int index = row;
+        for (int k = 0; k < inputCount; k++)
+        {
+            int radix = symbols.getDomainSize(inputVarIds[k]) + 1;
+            columns[k][row] = static_cast<quint16>(index % radix);
+            index /= radix;
+        }
+    }
+    for (int k = 0; k < inputCount; k++)
+    {
+        columns[k][combinationCount + k] = static_cast<quint16>(symbols.getDomainSize(inputVarIds[k]) + 1);
+    }
+    
+    for (const std::vector<quint16> &column : columns)
+    {
+        input.columns.push_back(column.data());
+    }
+}
+
+QMap<QString, QString> TestInputSpace::row(int r) const
+{
+    const SymbolTable &symbols = interp.getSymbols();
+    const std::vector<int> &inputVarIds = interp.getInputVarIds();
+    
+    QMap<QString, QString> result;
+    for (size_t k = 0; k < inputVarIds.size(); k++)
+    {
+        quint16 code = columns[k][r];
+        if (code != 0) result.insert(symbols.getVarName(inputVarIds[k]), symbols.getValueName(inputVarIds[k], code));
+    }
+    return result;
+}
+
+TestOutput::TestOutput(const Interpreter &interp, int rowCount) :
+    columns(interp.getOutputVarIds().size(), std::vector<quint16>(rowCount, 0))
+{
+    for (std::vector<quint16> &column : columns)
+    {
+        output.columns.push_back(column.data());
+    }
+}
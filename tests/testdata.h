@@ -0,0 +1,70 @@
+#ifndef TESTDATA_H
+#define TESTDATA_H
+
+#include "project.h"
+#include "interpreter.h"
+
+#include <vector>
+
+
+// Random Project in layers: Rules read Variables of lower layers and assign Variables of a higher one,
+// so there are no cycles and every Rule can fire. Layer "0" holds the Input Variables.
+// The same "seed" always gives the same Project
+struct TestProject
+{
+    TestProject(quint32 seed, int layerCount, int varsPerLayer, int valueCount, int ruleCount);
+    
+    // Writes ".var" and ".rul" Files in the text format; returns "false" if they can not be written
+    bool writeText(const QString &varFilePath, const QString &rulFilePath) const;
+    
+    QStringList varNames;
+    QList<QStringList> varValues;
+    QList<Rule> rules;
+};
+
+// Columnar block of random Value codes, "0" (unset) included, for the required Inputs of the Interpreter
+struct TestInput
+{
+    TestInput(const Interpreter &interp, int rowCount, quint32 seed);
+    // "input" points into "columns"
+    TestInput(const TestInput &) = delete;
+    
+    // Names and Values of the row, as "Interpreter::interpret()" takes them
+    QMap<QString, QString> row(int r) const;
+    
+    const Interpreter &interp;
+    std::vector<std::vector<quint16>> columns;
+    Interpreter::BatchInput input;
+};
+
+// Every combination of Input codes "0 ... domain size", the first Input Variable changing fastest,
+// followed by one row per Input Variable with the code just out of its domain
+struct TestInputSpace
+{
+    explicit TestInputSpace(const Interpreter &interp);
+    // "input" points into "columns"
+    TestInputSpace(const TestInputSpace &) = delete;
+    
+    // Names and Values of the row; rows out of the domain have no names
+    QMap<QString, QString> row(int r) const;
+    
+    const Interpreter &interp;
+    int combinationCount;
+    std::vector<std::vector<quint16>> columns;
+    Interpreter::BatchInput input;
+};
+
+// Output block of "Interpreter::interpretBatch()"; compared column by column
+struct TestOutput
+{
+    TestOutput(const Interpreter &interp, int rowCount);
+    // "output" points into "columns"
+    TestOutput(const TestOutput &) = delete;
+    
+    inline bool operator==(const TestOutput &other) const { return columns == other.columns; }
+    
+    std::vector<std::vector<quint16>> columns;
+    Interpreter::BatchOutput output;
+};
+
+#endif // TESTDATA_H
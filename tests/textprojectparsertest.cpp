@@ -0,0 +1,230 @@
+#include "textprojectparsertest.h"
+#include "testdata.h"
+#include "textprojectparser.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QtTest>
+
+
+namespace
+{
+
+// The loader of Project before "TextProjectParser"; it only reads well-formed Files
+void splitLoad(const QString &varFilePath, const QString &rulFilePath, QStringList *varNames, QList<QStringList> *varValues, QList<Rule> *rules)
+{
+    QFile varFile(varFilePath);
+    varFile.open(QFile::ReadOnly);
+    QTextStream varFileStream(&varFile);
+    while (!varFileStream.atEnd())
+    {
+        QStringList line = varFileStream.readLine().split(".");
+        varNames->append(line.at(0));
+        varValues->append(line.mid(1));
+    }
+    
+    QFile rulFile(rulFilePath);
+    rulFile.open(QFile::ReadOnly);
+    QTextStream rulFileStream(&rulFile);
+    while (!rulFileStream.atEnd())
+    {
+        Rule r;
+        QStringList line = rulFileStream.readLine().split("-");
+        
+        for (const QString &ifPair : line.at(0).split("&"))
+        {
+            QStringList pair = ifPair.split("=");
+            if (pair.length() < 2) continue;
+            r.ifBlock.append(Pair(pair.at(0), pair.at(1)));
+        }
+        for (const QString &thenPair : line.at(1).split("&"))
+        {
+            QStringList pair = thenPair.split("=");
+            if (pair.length() < 2) continue;
+            r.thenBlock.append(Pair(pair.at(0), pair.at(1)));
+        }
+        
+        rules->append(r);
+    }
+}
+
+}
+
+void TextProjectParserTest::initTestCase()
+{
+    QVERIFY(dir.isValid());
+    varFilePath = dir.filePath("test.var");
+    rulFilePath = dir.filePath("test.rul");
+    QVERIFY(TestProject(1, 4, 50, 8, 50000).writeText(varFilePath, rulFilePath));
+}
+
+void TextProjectParserTest::sameAsSplitLoader()
+{
+    QStringList expectedVarNames;
+    QList<QStringList> expectedVarValues;
+    QList<Rule> expectedRules;
+    splitLoad(varFilePath, rulFilePath, &expectedVarNames, &expectedVarValues, &expectedRules);
+    
+    QStringList varNames;
+    QList<QStringList> varValues;
+    QList<Rule> rules;
+    TextProjectParser parser;
+    QVERIFY(parser.parseVarFile(varFilePath, &varNames, &varValues));
+    QVERIFY(parser.parseRulFile(rulFilePath, &rules));
+    QCOMPARE(parser.getErrorCount(), 0);
+    
+    QCOMPARE(varNames, expectedVarNames);
+    QCOMPARE(varValues, expectedVarValues);
+    QCOMPARE(rules.length(), expectedRules.length());
+    for (int r = 0; r < rules.length(); r++)
+    {
+        QVERIFY(rules.at(r).ifBlock == expectedRules.at(r).ifBlock);
+        QVERIFY(rules.at(r).thenBlock == expectedRules.at(r).thenBlock);
+    }
+}
+
+void TextProjectParserTest::chunkIdentity()
+{
+    // Malformed lines every now and then, so that error line numbers are checked too
+    QFile rulFile(rulFilePath);
+    QVERIFY(rulFile.open(QFile::ReadOnly));
+    QList<QByteArray> lines = rulFile.readAll().split('\n');
+    rulFile.close();
+    for (int i = lines.length() - 1; i > 0; i -= 997)
+    {
+        lines.insert(i, (i % 2 ? "x0_0=v0&x0_1" : "x0_0=v0-x1_0=v1-x1_1=v1"));
+    }
+    QString badRulFilePath = dir.filePath("bad.rul");
+    QFile badRulFile(badRulFilePath);
+    QVERIFY(badRulFile.open(QFile::WriteOnly | QFile::Truncate));
+    badRulFile.write(lines.join('\n'));
+    badRulFile.close();
+    
+    TextProjectParser single(badRulFile.size() + 1);
+    QStringList varNames;
+    QList<QStringList> varValues;
+    QList<Rule> rules;
+    QVERIFY(single.parseVarFile(varFilePath, &varNames, &varValues));
+    QVERIFY(single.parseRulFile(badRulFilePath, &rules));
+    QVERIFY(single.getErrorCount() > 0);
+    
+    // Small chunks give as many chunks as the parser allows
+    TextProjectParser chunked(1024);
+    QStringList chunkedVarNames;
+    QList<QStringList> chunkedVarValues;
+    QList<Rule> chunkedRules;
+    QVERIFY(chunked.parseVarFile(varFilePath, &chunkedVarNames, &chunkedVarValues));
+    QVERIFY(chunked.parseRulFile(badRulFilePath, &chunkedRules));
+    
+    QCOMPARE(chunkedVarNames, varNames);
+    QCOMPARE(chunkedVarValues, varValues);
+    QCOMPARE(chunkedRules.length(), rules.length());
+    for (int r = 0; r < rules.length(); r++)
+    {
+        QVERIFY(chunkedRules.at(r).ifBlock == rules.at(r).ifBlock);
+        QVERIFY(chunkedRules.at(r).thenBlock == rules.at(r).thenBlock);
+    }
+    QCOMPARE(chunked.getErrorCount(), single.getErrorCount());
+    QCOMPARE(chunked.getErrors(), single.getErrors());
+}
+
+void TextProjectParserTest::diagnostics_data()
+{
+    QTest::addColumn<bool>("rulFile");
+    QTest::addColumn<QByteArray>("content");
+    QTest::addColumn<int>("count");
+    QTest::addColumn<QStringList>("errors");
+    
+    QTest::newRow("missing '-'") << true << QByteArray("a=x-b=y\nc=x\n") << 1
+                                 << QStringList("diag.rul:2:4: expected '-'");
+    QTest::newRow("extra '-'") << true << QByteArray("a=x-b=y-c=z") << 0
+                               << QStringList("diag.rul:1:8: unexpected '-'");
+    QTest::newRow("missing '='") << true << QByteArray("a=x&b-c=z") << 0
+                                 << QStringList("diag.rul:1:6: expected '='");
+    QTest::newRow("extra '='") << true << QByteArray("a=x=y-c=z") << 0
+                               << QStringList("diag.rul:1:4: unexpected '='");
+    QTest::newRow("missing names") << true << QByteArray("=x-c=z\na=-c=z\n-\n") << 1
+                                   << QStringList({"diag.rul:1:1: expected Variable Name", "diag.rul:2:3: expected Value"});
+    // "\r" is not counted as a column, blank lines are counted as lines
+    QTest::newRow("CRLF") << true << QByteArray("a=x-b=y\r\n\r\nc=x\r\n") << 1
+                          << QStringList("diag.rul:3:4: expected '-'");
+    QTest::newRow("missing Variable Name") << false << QByteArray("a.x\n.y\n") << 1
+                                           << QStringList("diag.var:2:1: expected Variable Name");
+    QTest::newRow("missing Values") << false << QByteArray("a.x..y\nb.x.\nc\n") << 1
+                                    << QStringList({"diag.var:1:5: expected Value", "diag.var:2:5: expected Value"});
+}
+
+void TextProjectParserTest::diagnostics()
+{
+    QFETCH(bool, rulFile);
+    QFETCH(QByteArray, content);
+    QFETCH(int, count);
+    QFETCH(QStringList, errors);
+    
+    QString filePath = dir.filePath(rulFile ? "diag.rul" : "diag.var");
+    QFile file(filePath);
+    QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+    QCOMPARE(file.write(content), static_cast<qint64>(content.size()));
+    file.close();
+    
+    TextProjectParser parser;
+    QStringList varNames;
+    QList<QStringList> varValues;
+    QList<Rule> rules;
+    if (rulFile)
+    {
+        QVERIFY(parser.parseRulFile(filePath, &rules));
+        QCOMPARE(rules.length(), count);
+    }
+    else
+    {
+        QVERIFY(parser.parseVarFile(filePath, &varNames, &varValues));
+        QCOMPARE(varNames.length(), count);
+    }
+    QCOMPARE(parser.getErrors(), errors);
+    QCOMPARE(parser.getErrorCount(), errors.length());
+}
+
+void TextProjectParserTest::speed_data()
+{
+    QTest::addColumn<bool>("split");
+    QTest::addColumn<int>("ruleCount");
+    
+    for (int ruleCount : {10000, 100000, 1000000})
+    {
+        QByteArray size = QByteArray::number(ruleCount / 1000) + "k";
+        QTest::newRow(("split loader " + size).constData()) << true << ruleCount;
+        QTest::newRow(("TextProjectParser " + size).constData()) << false << ruleCount;
+    }
+}
+
+void TextProjectParserTest::speed()
+{
+    QFETCH(bool, split);
+    QFETCH(int, ruleCount);
+    
+    // Written once for both loaders
+    QString speedVarFilePath = dir.filePath("speed" + QString::number(ruleCount) + ".var");
+    QString speedRulFilePath = dir.filePath("speed" + QString::number(ruleCount) + ".rul");
+    if (!QFile::exists(speedRulFilePath))
+    {
+        QVERIFY(TestProject(2, 4, 50, 8, ruleCount).writeText(speedVarFilePath, speedRulFilePath));
+    }
+    
+    QBENCHMARK
+    {
+        QStringList varNames;
+        QList<QStringList> varValues;
+        QList<Rule> rules;
+        if (split)
+        {
+            splitLoad(speedVarFilePath, speedRulFilePath, &varNames, &varValues, &rules);
+        }
+        else
+        {
+            TextProjectParser parser;
+            parser.parseVarFile(speedVarFilePath, &varNames, &varValues);
+            parser.parseRulFile(speedRulFilePath, &rules);
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef TEXTPROJECTPARSERTEST_H
+#define TEXTPROJECTPARSERTEST_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+
+class TextProjectParserTest : public QObject
+{
+    Q_OBJECT
+    
+private slots:
+    void initTestCase();
+    
+    // Same Lists as the loader splitting lines with "QString::split()" that "TextProjectParser" replaced
+    void sameAsSplitLoader();
+    // Cutting Files into chunks changes neither the Lists nor the errors
+    void chunkIdentity();
+    // Malformed lines are reported as "file:line:column: message" and skipped
+    void diagnostics_data();
+    void diagnostics();
+    // 10k, 100k and 1M Rules, each loaded by both loaders
+    void speed_data();
+    void speed();
+    
+private:
+    QTemporaryDir dir;
+    QString varFilePath;
+    QString rulFilePath;
+    
+};
+
+#endif // TEXTPROJECTPARSERTEST_H
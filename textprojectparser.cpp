@@ -0,0 +1,386 @@
+#include "textprojectparser.h"
+
+#include <QThread>
+
+#include <cstring>
+
+
+namespace
+{
+
+// FNV-1a
+inline quint32 hashBytes(const char *begin, const char *end)
+{
+    quint32 hash = 2166136261u;
+    for (const char *c = begin; c != end; c++)
+    {
+        hash = (hash ^ static_cast<uchar>(*c)) * 16777619u;
+    }
+    return hash;
+}
+
+inline const char *find(const char *begin, const char *end, char c)
+{
+    const void *found = memchr(begin, c, static_cast<size_t>(end - begin));
+    return (found ? static_cast<const char *>(found) : end);
+}
+
+}
+
+bool TextProjectParser::Content::open(const QString &filePath)
+{
+    begin = end = nullptr;
+    
+    file.setFileName(filePath);
+    if (!file.open(QFile::ReadOnly)) return false;
+    
+    qint64 size = file.size();
+    if (size == 0) return true;
+    
+    const uchar *data = file.map(0, size);
+    if (data)
+    {
+        begin = reinterpret_cast<const char *>(data);
+        end = begin + size;
+        return true;
+    }
+    
+    // Some files (pipes, special file systems) can not be mapped
+    buffer = file.readAll();
+    begin = buffer.constData();
+    end = begin + buffer.size();
+    return true;
+}
+
+TextProjectParser::StringPool::StringPool() :
+    buckets(64, -1)
+{
+    
+}
+
+int TextProjectParser::StringPool::intern(const char *begin, const char *end)
+{
+    int length = static_cast<int>(end - begin);
+    quint32 hash = hashBytes(begin, end);
+    size_t mask = buckets.size() - 1;
+    
+    size_t bucket = hash & mask;
+    while (buckets[bucket] != -1)
+    {
+        int id = buckets[bucket];
+        const QByteArray &key = keys[id];
+        if (hashes[id] == hash && key.size() == length && memcmp(key.constData(), begin, static_cast<size_t>(length)) == 0)
+        {
+            return id;
+        }
+        bucket = (bucket + 1) & mask;
+    }
+    
+    int id = static_cast<int>(keys.size());
+    buckets[bucket] = id;
+    hashes.push_back(hash);
+    keys.emplace_back(begin, length);
+    
+    // Keep the table at most half full
+    if (2 * keys.size() > buckets.size())
+    {
+        std::vector<int> grown(2 * buckets.size(), -1);
+        size_t grownMask = grown.size() - 1;
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            size_t b = hashes[i] & grownMask;
+            while (grown[b] != -1)
+            {
+                b = (b + 1) & grownMask;
+            }
+            grown[b] = static_cast<int>(i);
+        }
+        buckets.swap(grown);
+    }
+    
+    return id;
+}
+
+TextProjectParser::TextProjectParser(qint64 chunkBytes) :
+    chunkBytes(qMax<qint64>(1, chunkBytes)),
+    errorCount(0)
+{
+    
+}
+
+bool TextProjectParser::parseVarFile(const QString &filePath, QStringList *varNames, QList<QStringList> *varValues)
+{
+    std::vector<Chunk> chunks;
+    if (!parseFile(filePath, false, &chunks)) return false;
+    
+    for (const Chunk &chunk : chunks)
+    {
+        int recordCount = static_cast<int>(chunk.recordSplit.size());
+        for (int r = 0; r < recordCount; r++)
+        {
+            quint32 first = chunk.recordBegin[r];
+            quint32 last = chunk.recordBegin[r + 1];
+            varNames->append(strings[chunk.globalIds[chunk.ids[first]]]);
+            
+            QStringList valueBlock;
+            valueBlock.reserve(static_cast<int>(last - first - 1));
+            for (quint32 k = first + 1; k < last; k++)
+            {
+                valueBlock.append(strings[chunk.globalIds[chunk.ids[k]]]);
+            }
+            varValues->append(valueBlock);
+        }
+    }
+    return true;
+}
+
+bool TextProjectParser::parseRulFile(const QString &filePath, QList<Rule> *rules)
+{
+    std::vector<Chunk> chunks;
+    if (!parseFile(filePath, true, &chunks)) return false;
+    
+    // Rules are appended empty and then filled chunk by chunk; the List is not shared after appending,
+    // so the threads only touch their own Rules
+    std::vector<int> firstRule;
+    int ruleCount = rules->length();
+    for (const Chunk &chunk : chunks)
+    {
+        firstRule.push_back(ruleCount);
+        ruleCount += static_cast<int>(chunk.recordSplit.size());
+    }
+    rules->reserve(ruleCount);
+    while (rules->length() < ruleCount)
+    {
+        rules->append(Rule());
+    }
+    
+    runChunks(static_cast<int>(chunks.size()), [&](int c)
+    {
+        buildRules(chunks[c], rules, firstRule[c]);
+    });
+    return true;
+}
+
+int TextProjectParser::getErrorCount() const
+{
+    return errorCount;
+}
+
+const QStringList &TextProjectParser::getErrors() const
+{
+    return errors;
+}
+
+bool TextProjectParser::parseFile(const QString &filePath, bool rulFile, std::vector<Chunk> *chunks)
+{
+    Content content;
+    if (!content.open(filePath)) return false;
+    fileName = filePath.mid(filePath.lastIndexOf("/") + 1);
+    
+    // Chunk boundaries are moved forward to the next line start
+    qint64 size = content.end - content.begin;
+    int chunkCount = static_cast<int>(qBound<qint64>(1, size / chunkBytes, 8 * qMax(1, QThread::idealThreadCount())));
+    chunks->resize(chunkCount);
+    const char *begin = content.begin;
+    for (int i = 0; i < chunkCount; i++)
+    {
+        const char *end = content.end;
+        if (i + 1 < chunkCount)
+        {
+            end = content.begin + size * (i + 1) / chunkCount;
+            if (end < begin) end = begin;
+            end = find(end, content.end, '\n');
+            if (end != content.end) end++;
+        }
+        
+        (*chunks)[i].begin = begin;
+        (*chunks)[i].end = end;
+        begin = end;
+    }
+    
+    runChunks(chunkCount, [&](int c)
+    {
+        parseChunk(&(*chunks)[c], rulFile);
+    });
+    
+    // Chunks are merged in File order, so ids and errors come out as in a single pass
+    int lineOffset = 0;
+    for (Chunk &chunk : *chunks)
+    {
+        chunk.globalIds.resize(chunk.pool.getCount());
+        for (int id = 0; id < chunk.pool.getCount(); id++)
+        {
+            const QByteArray &key = chunk.pool.getKey(id);
+            int globalId = pool.intern(key.constData(), key.constData() + key.size());
+            if (globalId == static_cast<int>(strings.size())) strings.push_back(QString::fromUtf8(key));
+            chunk.globalIds[id] = globalId;
+        }
+        
+        for (const LineError &error : chunk.errors)
+        {
+            errorCount++;
+            if (errors.length() >= maxErrors) continue;
+            errors.append(fileName + ":" + QString::number(lineOffset + error.line) + ":" + QString::number(error.column) + ": " + error.message);
+        }
+        lineOffset += chunk.lineCount;
+    }
+    
+    return true;
+}
+
+void TextProjectParser::parseChunk(Chunk *chunk, bool rulFile)
+{
+    chunk->recordBegin.assign(1, 0);
+    chunk->lineCount = 0;
+    
+    for (const char *begin = chunk->begin; begin < chunk->end; )
+    {
+        const char *end = find(begin, chunk->end, '\n');
+        chunk->lineBegin = begin;
+        chunk->lineCount++;
+        
+        const char *lineEnd = (end != begin && end[-1] == '\r' ? end - 1 : end);
+        if (lineEnd != begin)
+        {
+            if (rulFile) parseRulLine(chunk, begin, lineEnd);
+            else parseVarLine(chunk, begin, lineEnd);
+        }
+        
+        begin = end + 1;
+    }
+}
+
+void TextProjectParser::parseVarLine(Chunk *chunk, const char *begin, const char *end)
+{
+    // Check the whole line first, so that a malformed one adds nothing
+    for (const char *token = begin; ; )
+    {
+        const char *tokenEnd = find(token, end, '.');
+        if (tokenEnd == token)
+        {
+            addError(chunk, token, (token == begin ? "expected Variable Name" : "expected Value"));
+            return;
+        }
+        if (tokenEnd == end) break;
+        token = tokenEnd + 1;
+    }
+    
+    for (const char *token = begin; ; )
+    {
+        const char *tokenEnd = find(token, end, '.');
+        chunk->ids.push_back(static_cast<quint32>(chunk->pool.intern(token, tokenEnd)));
+        if (tokenEnd == end) break;
+        token = tokenEnd + 1;
+    }
+    chunk->recordBegin.push_back(static_cast<quint32>(chunk->ids.size()));
+    chunk->recordSplit.push_back(1);
+}
+
+void TextProjectParser::parseRulLine(Chunk *chunk, const char *begin, const char *end)
+{
+    const char *separator = find(begin, end, '-');
+    if (separator == end)
+    {
+        addError(chunk, end, "expected '-'");
+        return;
+    }
+    const char *extra = find(separator + 1, end, '-');
+    if (extra != end)
+    {
+        addError(chunk, extra, "unexpected '-'");
+        return;
+    }
+    
+    size_t recordBegin = chunk->ids.size();
+    if (!parseBlock(chunk, begin, separator))
+    {
+        chunk->ids.resize(recordBegin);
+        return;
+    }
+    quint32 ifPairCount = static_cast<quint32>(chunk->ids.size() - recordBegin) / 2;
+    if (!parseBlock(chunk, separator + 1, end))
+    {
+        chunk->ids.resize(recordBegin);
+        return;
+    }
+    
+    chunk->recordBegin.push_back(static_cast<quint32>(chunk->ids.size()));
+    chunk->recordSplit.push_back(ifPairCount);
+}
+
+bool TextProjectParser::parseBlock(Chunk *chunk, const char *begin, const char *end)
+{
+    // Empty block is allowed
+    if (begin == end) return true;
+    
+    for (const char *pair = begin; ; )
+    {
+        const char *pairEnd = find(pair, end, '&');
+        const char *equals = find(pair, pairEnd, '=');
+        
+        if (equals == pairEnd)
+        {
+            addError(chunk, pairEnd, "expected '='");
+            return false;
+        }
+        if (equals == pair)
+        {
+            addError(chunk, pair, "expected Variable Name");
+            return false;
+        }
+        if (equals + 1 == pairEnd)
+        {
+            addError(chunk, pairEnd, "expected Value");
+            return false;
+        }
+        const char *extra = find(equals + 1, pairEnd, '=');
+        if (extra != pairEnd)
+        {
+            addError(chunk, extra, "unexpected '='");
+            return false;
+        }
+        
+        chunk->ids.push_back(static_cast<quint32>(chunk->pool.intern(pair, equals)));
+        chunk->ids.push_back(static_cast<quint32>(chunk->pool.intern(equals + 1, pairEnd)));
+        
+        if (pairEnd == end) break;
+        pair = pairEnd + 1;
+    }
+    return true;
+}
+
+void TextProjectParser::addError(Chunk *chunk, const char *position, const char *message)
+{
+    int column = static_cast<int>(position - chunk->lineBegin) + 1;
+    chunk->errors.push_back(LineError{chunk->lineCount, column, message});
+}
+
+void TextProjectParser::buildRules(const Chunk &chunk, QList<Rule> *rules, int first) const
+{
+    int recordCount = static_cast<int>(chunk.recordSplit.size());
+    for (int r = 0; r < recordCount; r++)
+    {
+        Rule &rule = (*rules)[first + r];
+        quint32 pairBegin = chunk.recordBegin[r];
+        quint32 pairEnd = chunk.recordBegin[r + 1];
+        quint32 split = pairBegin + 2 * chunk.recordSplit[r];
+        for (quint32 k = pairBegin; k < pairEnd; k += 2)
+        {
+            Pair p(strings[chunk.globalIds[chunk.ids[k]]], strings[chunk.globalIds[chunk.ids[k + 1]]]);
+            if (k < split) rule.ifBlock.append(p);
+            else rule.thenBlock.append(p);
+        }
+    }
+}
+
+void TextProjectParser::runChunks(int chunkCount, const std::function<void(int)> &task)
+{
+    if (chunkCount == 1)
+    {
+        task(0);
+        return;
+    }
+    
+    if (!workers) workers.reset(new WorkStealingPool);
+    workers->run(chunkCount, task);
+}
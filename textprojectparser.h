@@ -0,0 +1,129 @@
+#ifndef TEXTPROJECTPARSER_H
+#define TEXTPROJECTPARSER_H
+
+#include "project.h"
+#include "workstealingpool.h"
+
+#include <QFile>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+
+// Single-pass parser of ".var" and ".rul" Files working on the mapped bytes.
+// Lines are "Name.Value.Value" and "Var=Value&Var=Value-Var=Value&Var=Value"; "\r\n" endings and blank lines are accepted.
+// Identifiers are interned, so equal Names share one QString across both Files.
+// Malformed lines are skipped and reported as "file:line:column: message".
+// Large Files are cut at line ends into chunks parsed on all cores; the result does not depend on the number of chunks.
+class TextProjectParser
+{
+public:
+    // Files are cut into chunks of at least "chunkBytes"
+    explicit TextProjectParser(qint64 chunkBytes = minChunkBytes);
+    
+    // Return "false" if the File can not be read; parsed lines are appended to the Lists
+    bool parseVarFile(const QString &filePath, QStringList *varNames, QList<QStringList> *varValues);
+    bool parseRulFile(const QString &filePath, QList<Rule> *rules);
+    
+    // Total number of malformed lines; only the first "maxErrors" are kept
+    int getErrorCount() const;
+    const QStringList &getErrors() const;
+    
+    static const int maxErrors = 100;
+    // Default chunk size
+    static const qint64 minChunkBytes = 4 << 20;
+    
+private:
+    // Mapped contents of a File, or a copy of it if it can not be mapped
+    class Content
+    {
+    public:
+        bool open(const QString &filePath);
+        
+        const char *begin;
+        const char *end;
+    
+    private:
+        QFile file;
+        QByteArray buffer;
+    };
+    
+    // Interns byte strings into dense ids with open addressing; "-1" marks an empty bucket
+    class StringPool
+    {
+    public:
+        StringPool();
+        
+        int intern(const char *begin, const char *end);
+        
+        inline int getCount() const { return static_cast<int>(keys.size()); }
+        inline const QByteArray &getKey(int id) const { return keys[id]; }
+    
+    private:
+        std::vector<int> buckets;
+        std::vector<quint32> hashes;
+        std::vector<QByteArray> keys;
+    };
+    
+    struct LineError
+    {
+        int line;
+        int column;
+        const char *message;
+    };
+    
+    // Lines "[begin, end)" of a File, parsed independently into records of ids local to the chunk.
+    // Record "r" is ids[recordBegin[r], recordBegin[r + 1]): Name and Values of a Variable,
+    // or Variable and Value of every Pair of a Rule, where the first "recordSplit[r]" Pairs are IF-Pairs
+    struct Chunk
+    {
+        const char *begin;
+        const char *end;
+        
+        StringPool pool;
+        std::vector<quint32> recordBegin;
+        std::vector<quint32> recordSplit;
+        std::vector<quint32> ids;
+        
+        // Lines are numbered from "1" inside the chunk
+        int lineCount;
+        const char *lineBegin;
+        std::vector<LineError> errors;
+        
+        // Local id -> index in "strings"
+        std::vector<int> globalIds;
+    };
+    
+    // Splits the File, parses all chunks and interns their Strings in order
+    bool parseFile(const QString &filePath, bool rulFile, std::vector<Chunk> *chunks);
+    
+    static void parseChunk(Chunk *chunk, bool rulFile);
+    static void parseVarLine(Chunk *chunk, const char *begin, const char *end);
+    static void parseRulLine(Chunk *chunk, const char *begin, const char *end);
+    // Parses "Var=Value&Var=Value" up to "end"; returns "false" after reporting an error
+    static bool parseBlock(Chunk *chunk, const char *begin, const char *end);
+    static void addError(Chunk *chunk, const char *position, const char *message);
+    
+    // Builds Rules of the chunk into "rules[first ...]"
+    void buildRules(const Chunk &chunk, QList<Rule> *rules, int first) const;
+    
+    // Calls "task(i)" for every chunk, in parallel if there are several
+    void runChunks(int chunkCount, const std::function<void(int)> &task);
+    
+private:
+    qint64 chunkBytes;
+    QString fileName;
+    
+    int errorCount;
+    QStringList errors;
+    
+    StringPool pool;
+    std::vector<QString> strings;
+    
+    // Created for the first File with more than one chunk
+    std::unique_ptr<WorkStealingPool> workers;
+    
+};
+
+#endif // TEXTPROJECTPARSER_H
@@ -0,0 +1,94 @@
+#include "tracer.h"
+#include "interpreter.h"
+
+
+std::atomic<bool> Tracer::enabled(false);
+
+namespace
+{
+
+struct TraceBuffer
+{
+    TraceBuffer() : events(Tracer::bufferSize), recorded(0) {}
+    
+    std::vector<TraceEvent> events;
+    quint64 recorded;
+};
+
+TraceBuffer &threadBuffer()
+{
+    thread_local TraceBuffer buffer;
+    return buffer;
+}
+    
+}
+
+void Tracer::setEnabled(bool enabled)
+{
+    Tracer::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Tracer::record(const TraceEvent &event)
+{
+    TraceBuffer &buffer = threadBuffer();
+    buffer.events[buffer.recorded % bufferSize] = event;
+    buffer.recorded++;
+}
+
+std::vector<TraceEvent> Tracer::takeEvents()
+{
+    TraceBuffer &buffer = threadBuffer();
+    
+    quint64 first = (buffer.recorded > static_cast<quint64>(bufferSize)) ? buffer.recorded - bufferSize : 0;
+    
+    std::vector<TraceEvent> result;
+    result.reserve(buffer.recorded - first);
+    for (quint64 i = first; i < buffer.recorded; i++)
+    {
+        result.push_back(buffer.events[i % bufferSize]);
+    }
+    
+    buffer.recorded = 0;
+    return result;
+}
+
+QStringList Tracer::format(const std::vector<TraceEvent> &events, const Interpreter &interp)
+{
+    const RuleProgram &program = interp.getProgram();
+    
+    QStringList result;
+    for (const TraceEvent &event : events)
+    {
+        switch (event.kind) {
+        case TraceEventKind::InterpretationStarted:
+            result.append("Interpretation started");
+            break;
+        case TraceEventKind::RuleEvaluated:
+        {
+            if (static_cast<int>(event.rule) >= program.getRuleCount())
+            {
+                result.append("Unknown Rule : " + QString::number(event.rule));
+                break;
+            }
+            
+            Rule rule = interp.getCompiledRule(event.rule);
+            QString line = "Level " + QString::number(event.level)
+                    + ", Rule " + QString::number(program.ruleSource[event.rule] + 1)
+                    + " : " + rule.stringify() + " -> ";
+            
+            if (event.outcome)
+            {
+                line.append("fired");
+            }
+            else if (event.pair < rule.ifBlock.length())
+            {
+                line.append("IF-Pair " + rule.ifBlock.at(event.pair).stringify(true) + " gives False");
+            }
+            result.append(line);
+            break;
+        }
+        }
+    }
+    
+    return result;
+}
@@ -0,0 +1,61 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QtGlobal>
+#include <QStringList>
+
+#include <atomic>
+#include <vector>
+
+class Interpreter;
+
+
+enum class TraceEventKind : quint8
+{
+    InterpretationStarted = 0,
+    // "pair" is the number of IF-Pairs that held, "outcome" is "1" if the Rule fired
+    RuleEvaluated
+};
+
+// Compact binary record; names are restored only by "Tracer::format()"
+struct TraceEvent
+{
+    quint32 rule;
+    quint16 pair;
+    quint16 level;
+    TraceEventKind kind;
+    quint8 outcome;
+};
+
+// Structured execution tracing into a ring buffer per thread.
+// Compiled in only with "DEFINES += ES_TRACE"; even then nothing is recorded until "setEnabled(true)".
+class Tracer
+{
+public:
+    static void setEnabled(bool enabled);
+    static inline bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    
+    // Keeps only the newest events when the buffer is full
+    static void record(const TraceEvent &event);
+    
+    // Removes and returns events of the calling thread, oldest first
+    static std::vector<TraceEvent> takeEvents();
+    
+    // Offline conversion to readable text; "interp" must be the one that produced the events
+    static QStringList format(const std::vector<TraceEvent> &events, const Interpreter &interp);
+    
+public:
+    static const int bufferSize = 1 << 16;
+    
+private:
+    static std::atomic<bool> enabled;
+    
+};
+
+#ifdef ES_TRACE
+#define ES_TRACE_EVENT(...) do { if (Tracer::isEnabled()) Tracer::record(TraceEvent{__VA_ARGS__}); } while (0)
+#else
+#define ES_TRACE_EVENT(...) do { } while (0)
+#endif
+
+#endif // TRACER_H
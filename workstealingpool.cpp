@@ -0,0 +1,133 @@
+#include "workstealingpool.h"
+
+#include <QThread>
+
+
+WorkStealingPool::WorkStealingPool(int threadCount) :
+    currentTask(nullptr),
+    generation(0),
+    remaining(0),
+    activeWorkers(0),
+    stopping(false)
+{
+    if (threadCount <= 0) threadCount = QThread::idealThreadCount();
+    if (threadCount <= 0) threadCount = 1;
+    
+    for (int i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back(new Worker);
+    }
+    
+    for (int i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+int WorkStealingPool::getThreadCount() const
+{
+    return static_cast<int>(threads.size());
+}
+
+void WorkStealingPool::run(int taskCount, const std::function<void(int)> &task)
+{
+    if (taskCount <= 0) return;
+    
+    std::lock_guard<std::mutex> runLock(runMutex);
+    
+    // Contiguous blocks of tasks go to each thread
+    int threadCount = getThreadCount();
+    for (int i = 0; i < threadCount; i++)
+    {
+        int first = static_cast<int>(static_cast<qint64>(taskCount) * i / threadCount);
+        int last = static_cast<int>(static_cast<qint64>(taskCount) * (i + 1) / threadCount);
+        
+        std::lock_guard<std::mutex> lock(workers[i]->mutex);
+        for (int t = first; t < last; t++)
+        {
+            workers[i]->tasks.push_back(t);
+        }
+    }
+    
+    std::unique_lock<std::mutex> lock(stateMutex);
+    remaining = taskCount;
+    currentTask = &task;
+    generation++;
+    wakeUp.notify_all();
+    
+    allDone.wait(lock, [this] { return remaining == 0 && activeWorkers == 0; });
+    currentTask = nullptr;
+}
+
+void WorkStealingPool::workerLoop(int workerId)
+{
+    quint64 seenGeneration = 0;
+    
+    while (true)
+    {
+        const std::function<void(int)> *task;
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            wakeUp.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) return;
+            
+            seenGeneration = generation;
+            task = currentTask;
+            activeWorkers++;
+        }
+        
+        int taskId;
+        while (task && takeTask(workerId, &taskId))
+        {
+            (*task)(taskId);
+            remaining--;
+        }
+        
+        std::lock_guard<std::mutex> lock(stateMutex);
+        if (--activeWorkers == 0 && remaining == 0) allDone.notify_all();
+    }
+}
+
+bool WorkStealingPool::takeTask(int workerId, int *task)
+{
+    {
+        Worker &own = *workers[workerId];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            *task = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+    
+    // Own queue is empty: steal from the back of the others, starting with the neighbour
+    int threadCount = getThreadCount();
+    for (int i = 1; i < threadCount; i++)
+    {
+        Worker &victim = *workers[(workerId + i) % threadCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            *task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    
+    return false;
+}
@@ -0,0 +1,66 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Fixed set of threads, each with its own task queue.
+// A thread takes tasks from the front of its own queue and,
+// when it runs dry, steals from the back of the other queues.
+class WorkStealingPool
+{
+public:
+    // "0" means one thread per core
+    explicit WorkStealingPool(int threadCount = 0);
+    ~WorkStealingPool();
+    
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+    
+public:
+    int getThreadCount() const;
+    
+    // Calls "task(i)" for every "i" in [0, taskCount) and returns when all calls are finished.
+    // Neighbouring tasks are initially given to the same thread.
+    void run(int taskCount, const std::function<void(int)> &task);
+    
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<int> tasks;
+    };
+    
+private:
+    void workerLoop(int workerId);
+    bool takeTask(int workerId, int *task);
+    
+private:
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    
+    // Only one "run()" at a time
+    std::mutex runMutex;
+    
+    std::mutex stateMutex;
+    std::condition_variable wakeUp;
+    std::condition_variable allDone;
+    const std::function<void(int)> *currentTask;
+    quint64 generation;
+    std::atomic<int> remaining;
+    // Threads that may still take tasks of the current "run()"
+    int activeWorkers;
+    bool stopping;
+    
+};
+
+#endif // WORKSTEALINGPOOL_H